@@ -0,0 +1,244 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+
+/*
+ *  This file implements the analysis behind the spectrum view. A block
+ *  of PULSEAUDIO_ANALYZER_SIZE mono samples is windowed, transformed
+ *  with a real FFT computed as a half-size complex FFT, and folded into
+ *  log-spaced bands. All tables and buffers are allocated once, nothing
+ *  is allocated per block. Kept free of GTK so it can be benchmarked.
+ *
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_MATH_H
+#include <math.h>
+#endif
+
+#include <glib.h>
+
+#include "pulseaudio-analyzer.h"
+
+
+#define ANALYZER_HALF       (PULSEAUDIO_ANALYZER_SIZE / 2)
+#define ANALYZER_MIN_FREQ   40.0
+#define ANALYZER_MIN_DB     -70.0
+
+
+struct _PulseaudioAnalyzer
+{
+  /* transform tables */
+  gfloat                window[PULSEAUDIO_ANALYZER_SIZE];
+  gfloat                twiddle_re[ANALYZER_HALF / 2];
+  gfloat                twiddle_im[ANALYZER_HALF / 2];
+  gfloat                post_re[ANALYZER_HALF + 1];
+  gfloat                post_im[ANALYZER_HALF + 1];
+  guint16               bitrev[ANALYZER_HALF];
+  guint                 band_start[PULSEAUDIO_ANALYZER_N_BANDS + 1];
+
+  /* working buffers */
+  gfloat                input[PULSEAUDIO_ANALYZER_SIZE];
+  gfloat                re[ANALYZER_HALF];
+  gfloat                im[ANALYZER_HALF];
+  gfloat                power[ANALYZER_HALF + 1];
+};
+
+
+
+PulseaudioAnalyzer *
+pulseaudio_analyzer_new (void)
+{
+  PulseaudioAnalyzer *analyzer;
+  guint               i, bits, j;
+  gdouble             theta;
+  gdouble             freq;
+
+  analyzer = g_new0 (PulseaudioAnalyzer, 1);
+
+  /* Hann window */
+  for (i = 0; i < PULSEAUDIO_ANALYZER_SIZE; i++)
+    analyzer->window[i] = 0.5 - 0.5 * cos (2.0 * G_PI * i / (PULSEAUDIO_ANALYZER_SIZE - 1));
+
+  /* twiddles of the half-size complex transform */
+  for (i = 0; i < ANALYZER_HALF / 2; i++)
+    {
+      theta = 2.0 * G_PI * i / ANALYZER_HALF;
+      analyzer->twiddle_re[i] = cos (theta);
+      analyzer->twiddle_im[i] = -sin (theta);
+    }
+
+  /* twiddles splitting the complex result into the real spectrum */
+  for (i = 0; i <= ANALYZER_HALF; i++)
+    {
+      theta = 2.0 * G_PI * i / PULSEAUDIO_ANALYZER_SIZE;
+      analyzer->post_re[i] = cos (theta);
+      analyzer->post_im[i] = -sin (theta);
+    }
+
+  for (bits = 0; (1u << bits) < ANALYZER_HALF; bits++);
+  for (i = 0; i < ANALYZER_HALF; i++)
+    {
+      analyzer->bitrev[i] = 0;
+      for (j = 0; j < bits; j++)
+        if (i & (1u << j))
+          analyzer->bitrev[i] |= 1u << (bits - 1 - j);
+    }
+
+  /* log-spaced bands, each at least one bin wide */
+  for (i = 0; i <= PULSEAUDIO_ANALYZER_N_BANDS; i++)
+    {
+      freq = ANALYZER_MIN_FREQ * pow ((PULSEAUDIO_ANALYZER_RATE / 2.0) / ANALYZER_MIN_FREQ,
+                                      (gdouble) i / PULSEAUDIO_ANALYZER_N_BANDS);
+      analyzer->band_start[i] = (guint) (freq * PULSEAUDIO_ANALYZER_SIZE / PULSEAUDIO_ANALYZER_RATE);
+      if (i > 0)
+        analyzer->band_start[i] = MAX (analyzer->band_start[i], analyzer->band_start[i - 1] + 1);
+      analyzer->band_start[i] = MIN (analyzer->band_start[i], ANALYZER_HALF + 1);
+    }
+
+  return analyzer;
+}
+
+
+
+void
+pulseaudio_analyzer_free (PulseaudioAnalyzer *analyzer)
+{
+  g_free (analyzer);
+}
+
+
+
+/* where the caller puts the next block of samples */
+gfloat *
+pulseaudio_analyzer_get_input (PulseaudioAnalyzer *analyzer)
+{
+  g_return_val_if_fail (analyzer != NULL, NULL);
+
+  return analyzer->input;
+}
+
+
+
+/* in-place radix-2 transform of re/im */
+static void
+pulseaudio_analyzer_fft (PulseaudioAnalyzer *analyzer)
+{
+  gfloat *re = analyzer->re;
+  gfloat *im = analyzer->im;
+  gfloat  wr, wi, tr, ti;
+  guint   size, half, step;
+  guint   i, j, k;
+
+  for (i = 0; i < ANALYZER_HALF; i++)
+    {
+      j = analyzer->bitrev[i];
+      if (j > i)
+        {
+          tr = re[i]; re[i] = re[j]; re[j] = tr;
+          ti = im[i]; im[i] = im[j]; im[j] = ti;
+        }
+    }
+
+  for (size = 2; size <= ANALYZER_HALF; size <<= 1)
+    {
+      half = size >> 1;
+      step = ANALYZER_HALF / size;
+      for (i = 0; i < ANALYZER_HALF; i += size)
+        for (k = 0; k < half; k++)
+          {
+            wr = analyzer->twiddle_re[k * step];
+            wi = analyzer->twiddle_im[k * step];
+            j = i + k + half;
+            tr = re[j] * wr - im[j] * wi;
+            ti = re[j] * wi + im[j] * wr;
+            re[j] = re[i + k] - tr;
+            im[j] = im[i + k] - ti;
+            re[i + k] += tr;
+            im[i + k] += ti;
+          }
+    }
+}
+
+
+
+/* fills power[] with the spectrum of the windowed input */
+static void
+pulseaudio_analyzer_analyze (PulseaudioAnalyzer *analyzer)
+{
+  gfloat er, ei, or, oi, xr, xi;
+  guint  a, b, k;
+
+  /* even samples go to the real part, odd ones to the imaginary part */
+  for (k = 0; k < ANALYZER_HALF; k++)
+    {
+      analyzer->re[k] = analyzer->input[2 * k] * analyzer->window[2 * k];
+      analyzer->im[k] = analyzer->input[2 * k + 1] * analyzer->window[2 * k + 1];
+    }
+
+  pulseaudio_analyzer_fft (analyzer);
+
+  for (k = 0; k <= ANALYZER_HALF; k++)
+    {
+      a = k % ANALYZER_HALF;
+      b = (ANALYZER_HALF - k) % ANALYZER_HALF;
+
+      er = 0.5f * (analyzer->re[a] + analyzer->re[b]);
+      ei = 0.5f * (analyzer->im[a] - analyzer->im[b]);
+      or = 0.5f * (analyzer->im[a] + analyzer->im[b]);
+      oi = -0.5f * (analyzer->re[a] - analyzer->re[b]);
+
+      xr = er + analyzer->post_re[k] * or - analyzer->post_im[k] * oi;
+      xi = ei + analyzer->post_re[k] * oi + analyzer->post_im[k] * or;
+
+      analyzer->power[k] = xr * xr + xi * xi;
+    }
+}
+
+
+
+/* analyses the input block and stores one level per band, 0..1 */
+void
+pulseaudio_analyzer_run (PulseaudioAnalyzer *analyzer,
+                         gfloat             *levels)
+{
+  gdouble sum;
+  gdouble level;
+  guint   i, k;
+
+  g_return_if_fail (analyzer != NULL);
+
+  pulseaudio_analyzer_analyze (analyzer);
+
+  for (i = 0; i < PULSEAUDIO_ANALYZER_N_BANDS; i++)
+    {
+      sum = 0.0;
+      for (k = analyzer->band_start[i]; k < analyzer->band_start[i + 1]; k++)
+        sum += analyzer->power[k];
+      sum /= MAX (analyzer->band_start[i + 1] - analyzer->band_start[i], 1);
+
+      /* a full scale sine gives (N/4)^2 with the Hann window */
+      level = 10.0 * log10 (sum / ((PULSEAUDIO_ANALYZER_SIZE / 4.0) * (PULSEAUDIO_ANALYZER_SIZE / 4.0)) + 1e-12);
+      levels[i] = CLAMP ((level - ANALYZER_MIN_DB) / -ANALYZER_MIN_DB, 0.0, 1.0);
+    }
+}
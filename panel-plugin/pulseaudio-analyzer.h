@@ -0,0 +1,40 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __PULSEAUDIO_ANALYZER_H__
+#define __PULSEAUDIO_ANALYZER_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define PULSEAUDIO_ANALYZER_RATE      32000
+#define PULSEAUDIO_ANALYZER_SIZE      1024
+#define PULSEAUDIO_ANALYZER_N_BANDS   24
+
+typedef struct          _PulseaudioAnalyzer               PulseaudioAnalyzer;
+
+PulseaudioAnalyzer     *pulseaudio_analyzer_new           (void);
+void                    pulseaudio_analyzer_free          (PulseaudioAnalyzer *analyzer);
+
+gfloat                 *pulseaudio_analyzer_get_input     (PulseaudioAnalyzer *analyzer);
+void                    pulseaudio_analyzer_run           (PulseaudioAnalyzer *analyzer,
+                                                           gfloat             *levels);
+
+G_END_DECLS
+
+#endif /* !__PULSEAUDIO_ANALYZER_H__ */
@@ -42,36 +42,63 @@
 
 #include "pulseaudio-plugin.h"
 #include "pulseaudio-config.h"
+#include "pulseaudio-debug.h"
 #include "pulseaudio-menu.h"
+#include "pulseaudio-icons.h"
 #include "pulseaudio-button.h"
 
-#define V_MUTED  0
-#define V_LOW    1
-#define V_MEDIUM 2
-#define V_HIGH   3
 
+#define PULSEAUDIO_BUTTON_CSS "#pulseaudio-button { -GtkWidget-focus-padding: 0; -GtkWidget-focus-line-width: 0; -GtkButton-default-border: 0; -GtkButton-inner-border: 0; padding: 1px; border-width: 1px;}"
 
-/* Icons for different volume levels */
-static const char *icons[] = {
-  "audio-volume-muted-symbolic",
-  "audio-volume-low-symbolic",
-  "audio-volume-medium-symbolic",
-  "audio-volume-high-symbolic",
-  NULL
-};
+/* Style provider shared by all button instances */
+static GtkCssProvider *css_provider = NULL;
+
+/* Work deferred to the next frame */
+#define PENDING_STATE  (1 << 0)
+#define PENDING_STYLE  (1 << 1)
+#define PENDING_SIZE   (1 << 2)
+
+/* Peak updates per second of the level overlay */
+#define OVERLAY_RATE   10
+/* Thickness of the level overlay, in pixels */
+#define OVERLAY_BAR    2
+
+/* Colour of the recording badge */
+#define BADGE_COLOR    "#e01b24"
 
 
 
 static void                 pulseaudio_button_finalize        (GObject            *object);
+static void                 pulseaudio_button_map             (GtkWidget          *widget);
+static void                 pulseaudio_button_unmap           (GtkWidget          *widget);
 static gboolean             pulseaudio_button_button_press    (GtkWidget          *widget,
                                                                GdkEventButton     *event);
 static gboolean             pulseaudio_button_scroll_event    (GtkWidget          *widget,
                                                                GdkEventScroll     *event);
+static gboolean             pulseaudio_button_query_tooltip   (GtkWidget          *widget,
+                                                               gint                x,
+                                                               gint                y,
+                                                               gboolean            keyboard_mode,
+                                                               GtkTooltip         *tooltip);
+static void                 pulseaudio_button_build_tooltips  (PulseaudioButton   *button);
 static void                 pulseaudio_button_menu_deactivate (PulseaudioButton   *button,
                                                                GtkMenuShell       *menu);
-static void                 pulseaudio_button_update_icons    (PulseaudioButton   *button);
+static void                 pulseaudio_button_queue_update    (PulseaudioButton   *button,
+                                                               guint               pending);
+static gboolean             pulseaudio_button_update_tick     (GtkWidget          *widget,
+                                                               GdkFrameClock      *frame_clock,
+                                                               gpointer            user_data);
+static void                 pulseaudio_button_style_updated   (PulseaudioButton   *button);
+static gboolean             pulseaudio_button_update_style    (PulseaudioButton   *button);
+static gboolean             pulseaudio_button_update_icon_size (PulseaudioButton   *button);
+static void                 pulseaudio_button_load_surfaces   (PulseaudioButton   *button);
 static void                 pulseaudio_button_update          (PulseaudioButton   *button,
                                                                gboolean            force_update);
+static void                 pulseaudio_button_update_meter    (PulseaudioButton   *button);
+static void                 pulseaudio_button_queue_overlay   (PulseaudioButton   *button);
+static gboolean             pulseaudio_button_draw_overlay    (GtkWidget          *widget,
+                                                               cairo_t            *cr,
+                                                               PulseaudioButton   *button);
 
 
 struct _PulseaudioButton
@@ -83,14 +110,63 @@ struct _PulseaudioButton
   PulseaudioVolume     *volume;
 
   GtkWidget            *image;
+  GtkStyleContext      *style_context;
+
+  /* Panel row size and the button's padding plus border */
+  gint                  size;
+  gint                  thickness;
 
-  /* Icon size currently used */
+  /* Icon size, colour, scale and cache generation currently used */
   gint                  icon_size;
-  const gchar          *icon_name;
+  GdkRGBA               icon_color;
+  gint                  icon_scale;
+  guint                 icon_serial;
+  PulseaudioIconLevel   icon_level;
+
+  /* Pre-rendered icons for the current size, scale and style */
+  cairo_surface_t      *surfaces[PULSEAUDIO_N_ICONS];
+
+  /* Preformatted tooltips indexed by volume percentage */
+  gchar               **tooltips;
+  gchar               **tooltips_muted;
+  guint                 tooltips_max;
 
   GtkWidget            *menu;
 
+  /* Fractional scroll deltas not yet applied */
+  gdouble               scroll_accum_x;
+  gdouble               scroll_accum_y;
+
+  /* Whole scroll steps collected during the current frame */
+  gint                  scroll_steps_x;
+  gint                  scroll_steps_y;
+  guint                 scroll_tick_id;
+
+  /* Toplevel window watched for visibility changes */
+  GtkWidget            *toplevel;
+  gulong                visibility_id;
+  gboolean              obscured;
+  gboolean              visible;
+
+  /* Pending updates, applied once per frame */
+  guint                 pending;
+  guint                 update_tick_id;
+  guint                 updates_requested;
+  guint                 updates_applied;
+
+  /* Overlay drawn over the icon and the peak stream feeding it */
+  PulseaudioOverlay     overlay;
+  PulseaudioMeter      *meter;
+  guint                 meter_timeout_id;
+  gdouble               level;
+
+  /* Some application is recording */
+  gboolean              recording;
+
   gulong                volume_changed_id;
+  gulong                volume_max_changed_id;
+  gulong                overlay_changed_id;
+  gulong                sink_running_id;
   gulong                deactivate_id;
 };
 
@@ -114,8 +190,11 @@ pulseaudio_button_class_init (PulseaudioButtonClass *klass)
   gobject_class->finalize = pulseaudio_button_finalize;
 
   gtkwidget_class = GTK_WIDGET_CLASS (klass);
+  gtkwidget_class->map                  = pulseaudio_button_map;
+  gtkwidget_class->unmap                = pulseaudio_button_unmap;
   gtkwidget_class->button_press_event   = pulseaudio_button_button_press;
   gtkwidget_class->scroll_event         = pulseaudio_button_scroll_event;
+  gtkwidget_class->query_tooltip        = pulseaudio_button_query_tooltip;
 }
 
 
@@ -123,7 +202,7 @@ pulseaudio_button_class_init (PulseaudioButtonClass *klass)
 static void
 pulseaudio_button_init (PulseaudioButton *button)
 {
-  GtkCssProvider *css_provider;
+  guint           i;
 
   gtk_widget_set_can_focus(GTK_WIDGET(button), FALSE);
   gtk_widget_set_can_default (GTK_WIDGET (button), FALSE);
@@ -132,30 +211,70 @@ pulseaudio_button_init (PulseaudioButton *button)
   gtk_button_set_focus_on_click (GTK_BUTTON (button), FALSE);
   gtk_widget_set_name (GTK_WIDGET (button), "pulseaudio-button");
 
-  /* Preload icons */
-  g_signal_connect (G_OBJECT (button), "style-updated", G_CALLBACK (pulseaudio_button_update_icons), button);
+  /* Reload icons and metrics once per frame on style changes */
+  g_signal_connect (G_OBJECT (button), "style-updated", G_CALLBACK (pulseaudio_button_style_updated), button);
+  g_signal_connect (G_OBJECT (button), "notify::scale-factor", G_CALLBACK (pulseaudio_button_style_updated), button);
 
-  /* Setup Gtk style */
-  css_provider = gtk_css_provider_new ();
-  gtk_css_provider_load_from_data (css_provider, "#pulseaudio-button { -GtkWidget-focus-padding: 0; -GtkWidget-focus-line-width: 0; -GtkButton-default-border: 0; -GtkButton-inner-border: 0; padding: 1px; border-width: 1px;}", -1, NULL);
-  gtk_style_context_add_provider (GTK_STYLE_CONTEXT (gtk_widget_get_style_context (GTK_WIDGET (button))), GTK_STYLE_PROVIDER (css_provider), GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+  /* Setup Gtk style, the provider is parsed and installed only once */
+  if (css_provider == NULL)
+    {
+      css_provider = gtk_css_provider_new ();
+      gtk_css_provider_load_from_data (css_provider, PULSEAUDIO_BUTTON_CSS, -1, NULL);
+      gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
+                                                 GTK_STYLE_PROVIDER (css_provider),
+                                                 GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    }
+  button->style_context = gtk_widget_get_style_context (GTK_WIDGET (button));
 
   /* Intercept scroll events */
-  gtk_widget_add_events (GTK_WIDGET (button), GDK_SCROLL_MASK);
+  gtk_widget_add_events (GTK_WIDGET (button), GDK_SCROLL_MASK | GDK_SMOOTH_SCROLL_MASK);
 
   button->plugin = NULL;
   button->config = NULL;
   button->volume = NULL;
+  button->size = 0;
+  button->thickness = 0;
   button->icon_size = 16;
-  button->icon_name = NULL;
+  button->icon_scale = 0;
+  button->icon_serial = 0;
+  button->icon_level = PULSEAUDIO_N_ICONS;
+  for (i = 0; i < PULSEAUDIO_N_ICONS; i++)
+    button->surfaces[i] = NULL;
+
+  button->tooltips = NULL;
+  button->tooltips_muted = NULL;
+  button->tooltips_max = 0;
 
   button->menu = NULL;
+  button->scroll_accum_x = 0.0;
+  button->scroll_accum_y = 0.0;
+  button->scroll_steps_x = 0;
+  button->scroll_steps_y = 0;
+  button->scroll_tick_id = 0;
+  button->toplevel = NULL;
+  button->visibility_id = 0;
+  button->obscured = FALSE;
+  button->visible = FALSE;
+  button->pending = 0;
+  button->update_tick_id = 0;
+  button->updates_requested = 0;
+  button->updates_applied = 0;
+  button->overlay = PULSEAUDIO_OVERLAY_NONE;
+  button->meter = NULL;
+  button->meter_timeout_id = 0;
+  button->level = 0.0;
+  button->recording = FALSE;
   button->volume_changed_id = 0;
+  button->volume_max_changed_id = 0;
+  button->overlay_changed_id = 0;
+  button->sink_running_id = 0;
   button->deactivate_id = 0;
 
   button->image = gtk_image_new ();
   gtk_container_add (GTK_CONTAINER (button), button->image);
   gtk_widget_show (button->image);
+  g_signal_connect_after (G_OBJECT (button->image), "draw",
+                          G_CALLBACK (pulseaudio_button_draw_overlay), button);
 
   g_object_set (G_OBJECT (button), "has-tooltip", TRUE, NULL);
 
@@ -170,6 +289,7 @@ static void
 pulseaudio_button_finalize (GObject *object)
 {
   PulseaudioButton *button = PULSEAUDIO_BUTTON (object);
+  guint             i;
 
   if (button->menu != NULL)
     {
@@ -178,10 +298,110 @@ pulseaudio_button_finalize (GObject *object)
       button->menu = NULL;
     }
 
+  if (button->volume_max_changed_id != 0)
+    g_signal_handler_disconnect (G_OBJECT (button->config), button->volume_max_changed_id);
+
+  if (button->overlay_changed_id != 0)
+    g_signal_handler_disconnect (G_OBJECT (button->config), button->overlay_changed_id);
+
+  if (button->sink_running_id != 0)
+    g_signal_handler_disconnect (G_OBJECT (button->volume), button->sink_running_id);
+
+  if (button->meter_timeout_id != 0)
+    g_source_remove (button->meter_timeout_id);
+
+  if (button->meter != NULL)
+    g_object_unref (G_OBJECT (button->meter));
+
+  g_strfreev (button->tooltips);
+  g_strfreev (button->tooltips_muted);
+
+  for (i = 0; i < PULSEAUDIO_N_ICONS; i++)
+    if (button->surfaces[i] != NULL)
+      cairo_surface_destroy (button->surfaces[i]);
+
   (*G_OBJECT_CLASS (pulseaudio_button_parent_class)->finalize) (object);
 }
 
 
+static void
+pulseaudio_button_update_visible (PulseaudioButton *button)
+{
+  gboolean visible;
+
+  visible = gtk_widget_get_mapped (GTK_WIDGET (button)) && !button->obscured;
+  if (visible == button->visible)
+    return;
+
+  button->visible = visible;
+  pulseaudio_debug ("Button %s", visible ? "visible" : "hidden");
+
+  if (button->volume != NULL)
+    pulseaudio_volume_set_ui_visible (button->volume, visible);
+
+  pulseaudio_button_update_meter (button);
+
+  /* Catch up with everything recorded while hidden in a single update */
+  if (visible && button->pending != 0 && button->update_tick_id == 0)
+    button->update_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (button),
+                                                           pulseaudio_button_update_tick,
+                                                           NULL, NULL);
+}
+
+
+static gboolean
+pulseaudio_button_visibility_notify (PulseaudioButton   *button,
+                                     GdkEventVisibility *event)
+{
+  /* An autohidden panel is moved off screen rather than unmapped */
+  button->obscured = (event->state == GDK_VISIBILITY_FULLY_OBSCURED);
+  pulseaudio_button_update_visible (button);
+
+  return FALSE;
+}
+
+
+static void
+pulseaudio_button_map (GtkWidget *widget)
+{
+  PulseaudioButton *button = PULSEAUDIO_BUTTON (widget);
+  GtkWidget        *toplevel;
+
+  (*GTK_WIDGET_CLASS (pulseaudio_button_parent_class)->map) (widget);
+
+  toplevel = gtk_widget_get_toplevel (widget);
+  if (button->toplevel == NULL && gtk_widget_is_toplevel (toplevel))
+    {
+      button->toplevel = toplevel;
+      gtk_widget_add_events (toplevel, GDK_VISIBILITY_NOTIFY_MASK);
+      button->visibility_id =
+        g_signal_connect_swapped (G_OBJECT (toplevel), "visibility-notify-event",
+                                  G_CALLBACK (pulseaudio_button_visibility_notify), button);
+    }
+
+  pulseaudio_button_update_visible (button);
+}
+
+
+static void
+pulseaudio_button_unmap (GtkWidget *widget)
+{
+  PulseaudioButton *button = PULSEAUDIO_BUTTON (widget);
+
+  if (button->toplevel != NULL)
+    {
+      g_signal_handler_disconnect (G_OBJECT (button->toplevel), button->visibility_id);
+      button->toplevel = NULL;
+      button->visibility_id = 0;
+    }
+  button->obscured = FALSE;
+
+  (*GTK_WIDGET_CLASS (pulseaudio_button_parent_class)->unmap) (widget);
+
+  pulseaudio_button_update_visible (button);
+}
+
+
 static gboolean
 pulseaudio_button_button_press (GtkWidget      *widget,
                                 GdkEventButton *event)
@@ -220,31 +440,162 @@ pulseaudio_button_button_press (GtkWidget      *widget,
 }
 
 
+static gint
+pulseaudio_button_take_scroll_steps (gdouble *accum,
+                                     gdouble  delta)
+{
+  gint steps;
+
+  /* Start over when the scroll direction is reversed */
+  if ((*accum > 0.0 && delta < 0.0) || (*accum < 0.0 && delta > 0.0))
+    *accum = 0.0;
+
+  *accum += delta;
+  steps = (gint) *accum;
+  *accum -= steps;
+
+  return steps;
+}
+
+
 static gboolean
-pulseaudio_button_scroll_event (GtkWidget *widget, GdkEventScroll *event)
+pulseaudio_button_scroll_tick (GtkWidget     *widget,
+                               GdkFrameClock *frame_clock,
+                               gpointer       user_data)
 {
   PulseaudioButton *button      = PULSEAUDIO_BUTTON (widget);
-  gdouble           volume      = pulseaudio_volume_get_volume (button->volume);
   gdouble           volume_step = pulseaudio_config_get_volume_step (button->config) / 100.0;
-  gdouble           new_volume;
 
+  button->scroll_tick_id = 0;
 
-  if (event->direction == 1) // decrease volume
-    new_volume = volume - volume_step;
-  else if (event->direction == 0) // increase volume
-    new_volume = MIN (volume + volume_step, MAX (volume, 1.0));
-  else
-    new_volume = volume;
+  /* Apply the net delta of all scroll events seen during this frame */
+  if (button->scroll_steps_y != 0)
+    pulseaudio_volume_step_volume (button->volume, -button->scroll_steps_y, FALSE);
+
+  /* Horizontal scrolling adjusts the balance */
+  if (button->scroll_steps_x != 0)
+    pulseaudio_volume_set_balance (button->volume,
+                                   pulseaudio_volume_get_balance (button->volume) + button->scroll_steps_x * volume_step);
+
+  if (button->scroll_steps_y != 0 || button->scroll_steps_x != 0)
+    pulseaudio_notify (button->plugin);
+
+  button->scroll_steps_x = 0;
+  button->scroll_steps_y = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static gboolean
+pulseaudio_button_scroll_event (GtkWidget *widget, GdkEventScroll *event)
+{
+  PulseaudioButton *button      = PULSEAUDIO_BUTTON (widget);
+  gdouble           delta_x     = 0.0;
+  gdouble           delta_y     = 0.0;
+
+  switch (event->direction)
+    {
+    case GDK_SCROLL_UP:
+      delta_y = -1.0;
+      break;
 
-  pulseaudio_volume_set_volume (button->volume, new_volume);
-  //g_debug ("dir: %d %f -> %f", event->direction, volume, new_volume);
+    case GDK_SCROLL_DOWN:
+      delta_y = 1.0;
+      break;
 
-  pulseaudio_notify (button->plugin);
+    case GDK_SCROLL_LEFT:
+      delta_x = -1.0;
+      break;
+
+    case GDK_SCROLL_RIGHT:
+      delta_x = 1.0;
+      break;
+
+    case GDK_SCROLL_SMOOTH:
+      gdk_event_get_scroll_deltas ((GdkEvent *) event, &delta_x, &delta_y);
+      break;
+
+    default:
+      return FALSE;
+    }
+
+  /* Touchpads and high-resolution wheels deliver fractional deltas,
+   * only whole volume steps are applied */
+  button->scroll_steps_y += pulseaudio_button_take_scroll_steps (&button->scroll_accum_y, delta_y);
+  button->scroll_steps_x += pulseaudio_button_take_scroll_steps (&button->scroll_accum_x, delta_x);
+
+  if ((button->scroll_steps_y != 0 || button->scroll_steps_x != 0) && button->scroll_tick_id == 0)
+    button->scroll_tick_id = gtk_widget_add_tick_callback (widget, pulseaudio_button_scroll_tick, NULL, NULL);
+
+  return TRUE;
+}
+
+
+static gboolean
+pulseaudio_button_query_tooltip (GtkWidget  *widget,
+                                 gint        x,
+                                 gint        y,
+                                 gboolean    keyboard_mode,
+                                 GtkTooltip *tooltip)
+{
+  PulseaudioButton *button = PULSEAUDIO_BUTTON (widget);
+  gint              percent;
+  gboolean          muted;
+  gchar            *text;
+
+  if (button->tooltips == NULL)
+    return FALSE;
+
+  /* Tooltip text is only needed when it is about to be shown */
+  percent = (gint) round (pulseaudio_volume_get_volume (button->volume) * 100);
+  muted = pulseaudio_volume_get_muted (button->volume);
+
+  /* The server volume is clamped to volume-max, but after volume-max
+   * is lowered the table is rebuilt before the sinks are listed again,
+   * so the last volume can briefly be past its end */
+  if (percent < 0 || percent > (gint) button->tooltips_max)
+    {
+      if (muted)
+        text = g_strdup_printf (_("Volume %d%% (muted)"), percent);
+      else
+        text = g_strdup_printf (_("Volume %d%%"), percent);
+      gtk_tooltip_set_text (tooltip, text);
+      g_free (text);
+    }
+  else if (muted)
+    gtk_tooltip_set_text (tooltip, button->tooltips_muted[percent]);
+  else
+    gtk_tooltip_set_text (tooltip, button->tooltips[percent]);
 
   return TRUE;
 }
 
 
+static void
+pulseaudio_button_build_tooltips (PulseaudioButton *button)
+{
+  guint i;
+
+  g_return_if_fail (IS_PULSEAUDIO_BUTTON (button));
+
+  g_strfreev (button->tooltips);
+  g_strfreev (button->tooltips_muted);
+
+  button->tooltips_max = pulseaudio_config_get_volume_max (button->config);
+  button->tooltips = g_new (gchar *, button->tooltips_max + 2);
+  button->tooltips_muted = g_new (gchar *, button->tooltips_max + 2);
+
+  for (i = 0; i <= button->tooltips_max; i++)
+    {
+      button->tooltips[i] = g_strdup_printf (_("Volume %d%%"), i);
+      button->tooltips_muted[i] = g_strdup_printf (_("Volume %d%% (muted)"), i);
+    }
+  button->tooltips[i] = NULL;
+  button->tooltips_muted[i] = NULL;
+}
+
+
 static void
 pulseaudio_button_menu_deactivate (PulseaudioButton *button,
                                    GtkMenuShell     *menu)
@@ -270,10 +621,62 @@ pulseaudio_button_menu_deactivate (PulseaudioButton *button,
 
 
 static void
-pulseaudio_button_update_icons (PulseaudioButton *button)
+pulseaudio_button_style_updated (PulseaudioButton *button)
 {
-  /* Update the state of the button */
-  pulseaudio_button_update (button, TRUE);
+  /* Theme switches emit this many times in a row */
+  pulseaudio_button_queue_update (button, PENDING_STYLE);
+}
+
+
+static gboolean
+pulseaudio_button_update_style (PulseaudioButton *button)
+{
+  GtkStateFlags state;
+  GtkBorder     padding;
+  GtkBorder     border;
+  GdkRGBA       color;
+  gint          scale;
+  guint         serial;
+  gboolean      changed;
+
+  /* Get widget's padding and border to correctly calculate the button's icon size */
+  state = gtk_widget_get_state_flags (GTK_WIDGET (button));
+  gtk_style_context_get_padding (button->style_context, state, &padding);
+  gtk_style_context_get_border (button->style_context, state, &border);
+  button->thickness = MAX (padding.left + padding.right + border.left + border.right,
+                           padding.top + padding.bottom + border.top + border.bottom);
+
+  /* Icons only need to be reloaded if their appearance may differ */
+  gtk_style_context_get_color (button->style_context, state, &color);
+  scale = gtk_widget_get_scale_factor (GTK_WIDGET (button));
+  serial = pulseaudio_icons_get_serial ();
+
+  changed = (!gdk_rgba_equal (&color, &button->icon_color) ||
+             scale != button->icon_scale ||
+             serial != button->icon_serial);
+
+  button->icon_color = color;
+  button->icon_scale = scale;
+  button->icon_serial = serial;
+
+  return changed;
+}
+
+
+static void
+pulseaudio_button_load_surfaces (PulseaudioButton *button)
+{
+  guint i;
+
+  for (i = 0; i < PULSEAUDIO_N_ICONS; i++)
+    {
+      if (button->surfaces[i] != NULL)
+        cairo_surface_destroy (button->surfaces[i]);
+
+      button->surfaces[i] = pulseaudio_icons_get_surface (GTK_WIDGET (button), i, button->icon_size);
+      if (button->surfaces[i] != NULL)
+        cairo_surface_reference (button->surfaces[i]);
+    }
 }
 
 
@@ -281,66 +684,266 @@ static void
 pulseaudio_button_update (PulseaudioButton *button,
                           gboolean          force_update)
 {
-  gdouble      volume;
-  gboolean     muted;
-  gchar       *tip_text;
-  const gchar *icon_name;
+  PulseaudioIconLevel level;
 
   g_return_if_fail (IS_PULSEAUDIO_BUTTON (button));
   g_return_if_fail (IS_PULSEAUDIO_VOLUME (button->volume));
 
-  volume = pulseaudio_volume_get_volume (button->volume);
-  muted = pulseaudio_volume_get_muted (button->volume);
-  if (muted)
-    icon_name = icons[V_MUTED];
-  else if (volume <= 0.0)
-    icon_name = icons[V_MUTED];
-  else if (volume <= 0.3)
-    icon_name = icons[V_LOW];
-  else if (volume <= 0.7)
-    icon_name = icons[V_MEDIUM];
+  level = pulseaudio_icons_get_level (pulseaudio_volume_get_volume (button->volume),
+                                      pulseaudio_volume_get_muted (button->volume));
+
+  /* Refresh the tooltip only if the pointer is over the button */
+  if (gtk_widget_get_state_flags (GTK_WIDGET (button)) & GTK_STATE_FLAG_PRELIGHT)
+    gtk_widget_trigger_tooltip_query (GTK_WIDGET (button));
+
+  if (force_update)
+    pulseaudio_button_load_surfaces (button);
+
+  /* The dial follows the volume, the whole icon is redrawn anyway on level changes */
+  if (button->overlay == PULSEAUDIO_OVERLAY_ARC)
+    pulseaudio_button_queue_overlay (button);
+
+  if (force_update || level != button->icon_level)
+    {
+      button->icon_level = level;
+      if (button->surfaces[level] != NULL)
+        {
+          gtk_image_set_from_surface (GTK_IMAGE (button->image), button->surfaces[level]);
+        }
+      else
+        {
+          gtk_image_set_from_icon_name (GTK_IMAGE (button->image), pulseaudio_icons_get_name (level), GTK_ICON_SIZE_BUTTON);
+          gtk_image_set_pixel_size (GTK_IMAGE (button->image), button->icon_size);
+        }
+    }
+}
+
+
+static void
+pulseaudio_button_get_overlay_area (PulseaudioButton *button,
+                                    GdkRectangle     *area)
+{
+  GtkAllocation allocation;
+  gint          size = button->icon_size;
+
+  /* The icon is centered in the image */
+  gtk_widget_get_allocation (button->image, &allocation);
+  area->x = (allocation.width - size) / 2;
+  area->y = (allocation.height - size) / 2;
+
+  if (button->overlay == PULSEAUDIO_OVERLAY_LEVEL)
+    {
+      /* A thin bar along the bottom edge */
+      area->y += size - OVERLAY_BAR;
+      area->width = size;
+      area->height = OVERLAY_BAR;
+    }
   else
-    icon_name = icons[V_HIGH];
+    {
+      /* A small dial in the bottom right corner */
+      area->x += size - size / 2;
+      area->y += size - size / 2;
+      area->width = size / 2;
+      area->height = size / 2;
+    }
+}
+
 
-  if (muted)
-    tip_text = g_strdup_printf (_("Volume %d%% (muted)"), (gint) round (volume * 100));
+static void
+pulseaudio_button_queue_overlay (PulseaudioButton *button)
+{
+  GdkRectangle area;
+
+  if (button->overlay == PULSEAUDIO_OVERLAY_NONE || !button->visible)
+    return;
+
+  /* The rest of the icon is left alone */
+  pulseaudio_button_get_overlay_area (button, &area);
+  gtk_widget_queue_draw_area (button->image, area.x, area.y, area.width, area.height);
+}
+
+
+static void
+pulseaudio_button_get_badge_area (PulseaudioButton *button,
+                                  GdkRectangle     *area)
+{
+  GtkAllocation allocation;
+  gint          size = button->icon_size;
+
+  /* A dot in the top right corner */
+  gtk_widget_get_allocation (button->image, &allocation);
+  area->width = MAX (size / 3, 4);
+  area->height = area->width;
+  area->x = (allocation.width - size) / 2 + size - area->width;
+  area->y = (allocation.height - size) / 2;
+}
+
+
+static void
+pulseaudio_button_draw_badge (PulseaudioButton *button,
+                              cairo_t          *cr)
+{
+  GdkRectangle area;
+  GdkRGBA      color;
+  gdouble      radius;
+
+  pulseaudio_button_get_badge_area (button, &area);
+  radius = area.width / 2.0;
+
+  gdk_rgba_parse (&color, BADGE_COLOR);
+  gdk_cairo_set_source_rgba (cr, &color);
+  cairo_arc (cr, area.x + radius, area.y + radius, radius, 0.0, 2 * G_PI);
+  cairo_fill (cr);
+}
+
+
+static void
+pulseaudio_button_recording_changed (PulseaudioButton *button)
+{
+  GdkRectangle area;
+  gboolean     recording;
+
+  recording = g_list_model_get_n_items (pulseaudio_volume_get_source_outputs (button->volume)) > 0;
+  if (recording == button->recording)
+    return;
+
+  button->recording = recording;
+  pulseaudio_debug ("Recording %s", recording ? "started" : "stopped");
+
+  pulseaudio_button_get_badge_area (button, &area);
+  gtk_widget_queue_draw_area (button->image, area.x, area.y, area.width, area.height);
+}
+
+
+static gboolean
+pulseaudio_button_draw_overlay (GtkWidget        *widget,
+                                cairo_t          *cr,
+                                PulseaudioButton *button)
+{
+  GdkRectangle area;
+  gdouble      fraction;
+  gdouble      radius;
+
+  if (button->recording)
+    pulseaudio_button_draw_badge (button, cr);
+
+  if (button->overlay == PULSEAUDIO_OVERLAY_NONE)
+    return FALSE;
+
+  pulseaudio_button_get_overlay_area (button, &area);
+  gdk_cairo_set_source_rgba (cr, &button->icon_color);
+
+  if (button->overlay == PULSEAUDIO_OVERLAY_LEVEL)
+    {
+      if (button->level > 0.0)
+        {
+          cairo_rectangle (cr, area.x, area.y, area.width * button->level, area.height);
+          cairo_fill (cr);
+        }
+    }
   else
-    tip_text = g_strdup_printf (_("Volume %d%%"), (gint) round (volume * 100));
-  gtk_widget_set_tooltip_text (GTK_WIDGET (button), tip_text);
-  g_free (tip_text);
+    {
+      fraction = pulseaudio_volume_get_volume (button->volume) * 100.0 /
+        pulseaudio_config_get_volume_max (button->config);
+      fraction = pulseaudio_volume_get_muted (button->volume) ? 0.0 : CLAMP (fraction, 0.0, 1.0);
+      radius = area.width / 2.0;
+
+      cairo_set_line_width (cr, 1.0);
+      cairo_arc (cr, area.x + radius, area.y + radius, radius - 0.5, 0.0, 2 * G_PI);
+      cairo_stroke (cr);
+      if (fraction > 0.0)
+        {
+          cairo_move_to (cr, area.x + radius, area.y + radius);
+          cairo_arc (cr, area.x + radius, area.y + radius, radius - 0.5,
+                     -G_PI / 2, -G_PI / 2 + 2 * G_PI * fraction);
+          cairo_close_path (cr);
+          cairo_fill (cr);
+        }
+    }
 
-  if (force_update || icon_name != button->icon_name)
+  return FALSE;
+}
+
+
+static gboolean
+pulseaudio_button_meter_timeout (gpointer user_data)
+{
+  PulseaudioButton *button = PULSEAUDIO_BUTTON (user_data);
+  gdouble           peak;
+  gdouble           level;
+
+  if (!pulseaudio_meter_take_peak (button->meter, &peak))
+    return G_SOURCE_CONTINUE;
+
+  /* Skip changes smaller than a pixel */
+  level = cbrt (peak);
+  if (ABS (level - button->level) * button->icon_size >= 1.0)
     {
-      button->icon_name = icon_name;
-      gtk_image_set_from_icon_name (GTK_IMAGE (button->image), icon_name, GTK_ICON_SIZE_BUTTON);
-      gtk_image_set_pixel_size (GTK_IMAGE (button->image), button->icon_size);
+      button->level = level;
+      pulseaudio_button_queue_overlay (button);
     }
+
+  return G_SOURCE_CONTINUE;
 }
 
 
-void
-pulseaudio_button_set_size (PulseaudioButton *button,
-                            gint              size)
+static void
+pulseaudio_button_update_meter (PulseaudioButton *button)
 {
-  GtkStyleContext  *context;
-  GtkBorder         padding;
-  GtkBorder         border;
-  gint              width;
-  gint              xthickness;
-  gint              ythickness;
-  gint              size_old;
+  gboolean wanted;
 
-  g_return_if_fail (IS_PULSEAUDIO_BUTTON (button));
-  g_return_if_fail (size > 0);
+  /* Nothing runs unless the bar can be seen and something is playing */
+  wanted = (button->overlay == PULSEAUDIO_OVERLAY_LEVEL &&
+            button->visible &&
+            button->volume != NULL &&
+            pulseaudio_volume_get_sink_running (button->volume));
 
-  /* Get widget's padding and border to correctly calculate the button's icon size */
-  context = gtk_widget_get_style_context (GTK_WIDGET (button));
-  gtk_style_context_get_padding (context, gtk_widget_get_state_flags (GTK_WIDGET (button)), &padding);
-  gtk_style_context_get_border (context, gtk_widget_get_state_flags (GTK_WIDGET (button)), &border);
-  xthickness = padding.left+padding.right+border.left+border.right;
-  ythickness = padding.top+padding.bottom+border.top+border.bottom;
+  if (wanted && button->meter == NULL)
+    {
+      button->meter = pulseaudio_volume_new_meter (button->volume, OVERLAY_RATE);
+      if (button->meter != NULL)
+        button->meter_timeout_id = g_timeout_add (1000 / OVERLAY_RATE,
+                                                  pulseaudio_button_meter_timeout,
+                                                  button);
+    }
+  else if (!wanted && button->meter != NULL)
+    {
+      g_source_remove (button->meter_timeout_id);
+      button->meter_timeout_id = 0;
+      g_object_unref (G_OBJECT (button->meter));
+      button->meter = NULL;
+    }
+
+  if (!wanted && button->level > 0.0)
+    {
+      button->level = 0.0;
+      pulseaudio_button_queue_overlay (button);
+    }
+}
+
+
+static void
+pulseaudio_button_overlay_changed (PulseaudioButton *button)
+{
+  /* Clear the old overlay before switching */
+  pulseaudio_button_queue_overlay (button);
+  button->overlay = pulseaudio_config_get_panel_overlay (button->config);
+  button->level = 0.0;
+  pulseaudio_button_update_meter (button);
+  pulseaudio_button_queue_overlay (button);
+}
+
+
+static gboolean
+pulseaudio_button_update_icon_size (PulseaudioButton *button)
+{
+  gint width;
+  gint size_old;
 
-  width = size - 2* MAX (xthickness, ythickness);
+  if (button->size <= 0)
+    return FALSE;
+
+  width = button->size - 2 * button->thickness;
   /* Since symbolic icons are usually only provided in 16px we
    * try to be clever and use size steps */
   size_old = button->icon_size;
@@ -353,9 +956,72 @@ pulseaudio_button_set_size (PulseaudioButton *button,
   else
       button->icon_size = width;
 
+  return button->icon_size != size_old;
+}
+
+
+void
+pulseaudio_button_set_size (PulseaudioButton *button,
+                            gint              size)
+{
+  g_return_if_fail (IS_PULSEAUDIO_BUTTON (button));
+  g_return_if_fail (size > 0);
+
+  if (size == button->size)
+    return;
+
+  button->size = size;
   gtk_widget_set_size_request (GTK_WIDGET (button), size, size);
-  if (button->icon_size != size_old)
-    pulseaudio_button_update_icons (button);
+
+  /* The icon size is recalculated on the next frame */
+  pulseaudio_button_queue_update (button, PENDING_SIZE);
+}
+
+
+
+static gboolean
+pulseaudio_button_update_tick (GtkWidget     *widget,
+                               GdkFrameClock *frame_clock,
+                               gpointer       user_data)
+{
+  PulseaudioButton *button = PULSEAUDIO_BUTTON (widget);
+  guint             pending = button->pending;
+  gboolean          reload = FALSE;
+
+  button->pending = 0;
+  button->update_tick_id = 0;
+
+  if (pending & PENDING_STYLE)
+    reload = pulseaudio_button_update_style (button);
+
+  if (pending & (PENDING_STYLE | PENDING_SIZE))
+    reload = pulseaudio_button_update_icon_size (button) || reload;
+
+  if (pending & PENDING_STATE)
+    {
+      button->updates_applied++;
+      pulseaudio_debug ("Button updates: %u requested, %u applied",
+                        button->updates_requested, button->updates_applied);
+    }
+
+  pulseaudio_button_update (button, reload);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+
+static void
+pulseaudio_button_queue_update (PulseaudioButton *button,
+                                guint             pending)
+{
+  button->pending |= pending;
+
+  /* While hidden only the latest state is recorded */
+  if (button->update_tick_id == 0 && button->visible)
+    button->update_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (button),
+                                                           pulseaudio_button_update_tick,
+                                                           NULL, NULL);
 }
 
 
@@ -366,7 +1032,9 @@ pulseaudio_button_volume_changed (PulseaudioButton  *button,
 {
   g_return_if_fail (IS_PULSEAUDIO_BUTTON (button));
 
-  pulseaudio_button_update (button, FALSE);
+  /* Any number of changes within a frame result in a single update */
+  button->updates_requested++;
+  pulseaudio_button_queue_update (button, PENDING_STATE);
 }
 
 
@@ -390,6 +1058,21 @@ pulseaudio_button_new (PulseaudioPlugin *plugin,
   button->volume_changed_id =
     g_signal_connect_swapped (G_OBJECT (button->volume), "volume-changed",
                               G_CALLBACK (pulseaudio_button_volume_changed), button);
+  button->volume_max_changed_id =
+    g_signal_connect_swapped (G_OBJECT (button->config), "notify::volume-max",
+                              G_CALLBACK (pulseaudio_button_build_tooltips), button);
+  button->overlay_changed_id =
+    g_signal_connect_swapped (G_OBJECT (button->config), "notify::panel-overlay",
+                              G_CALLBACK (pulseaudio_button_overlay_changed), button);
+  button->sink_running_id =
+    g_signal_connect_swapped (G_OBJECT (button->volume), "sink-running-changed",
+                              G_CALLBACK (pulseaudio_button_update_meter), button);
+  button->overlay = pulseaudio_config_get_panel_overlay (button->config);
+  g_signal_connect_object (G_OBJECT (pulseaudio_volume_get_source_outputs (button->volume)), "items-changed",
+                           G_CALLBACK (pulseaudio_button_recording_changed), button, G_CONNECT_SWAPPED);
+  pulseaudio_button_recording_changed (button);
+
+  pulseaudio_button_build_tooltips (button);
 
   pulseaudio_button_update (button, TRUE);
 
@@ -0,0 +1,319 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+
+/*
+ *  This file implements an entry of the card registry kept by
+ *  PulseaudioVolume, with the profiles of the card. Its ports are kept
+ *  by the sinks, which only list those of the active profile. Entries
+ *  emit "changed" only when something actually changes.
+ *
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib-object.h>
+#include <pulse/pulseaudio.h>
+
+#include "pulseaudio-card.h"
+
+
+static void                 pulseaudio_card_finalize          (GObject            *object);
+
+
+/* a profile */
+typedef struct
+{
+  gchar                *name;
+  gchar                *description;
+  gboolean              available;
+} PulseaudioCardOption;
+
+
+struct _PulseaudioCard
+{
+  GObject               __parent__;
+
+  guint32               index;
+  gchar                *name;
+  gchar                *description;
+  GArray               *profiles;
+  gchar                *active_profile;
+};
+
+struct _PulseaudioCardClass
+{
+  GObjectClass          __parent__;
+};
+
+
+
+
+enum
+{
+  CHANGED,
+  LAST_SIGNAL
+};
+
+static guint pulseaudio_card_signals[LAST_SIGNAL] = { 0, };
+
+
+
+
+G_DEFINE_TYPE (PulseaudioCard, pulseaudio_card, G_TYPE_OBJECT)
+
+static void
+pulseaudio_card_class_init (PulseaudioCardClass *klass)
+{
+  GObjectClass      *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->finalize = pulseaudio_card_finalize;
+
+  pulseaudio_card_signals[CHANGED] =
+    g_signal_new (g_intern_static_string ("changed"),
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL,
+                  g_cclosure_marshal_VOID__VOID,
+                  G_TYPE_NONE, 0);
+}
+
+
+
+static void
+pulseaudio_card_option_clear (gpointer data)
+{
+  PulseaudioCardOption *option = data;
+
+  g_free (option->name);
+  g_free (option->description);
+}
+
+
+
+static void
+pulseaudio_card_init (PulseaudioCard *card)
+{
+  card->index = PA_INVALID_INDEX;
+  card->name = NULL;
+  card->description = NULL;
+  card->profiles = g_array_new (FALSE, TRUE, sizeof (PulseaudioCardOption));
+  g_array_set_clear_func (card->profiles, pulseaudio_card_option_clear);
+  card->active_profile = NULL;
+}
+
+
+
+static void
+pulseaudio_card_finalize (GObject *object)
+{
+  PulseaudioCard *card = PULSEAUDIO_CARD (object);
+
+  g_free (card->name);
+  g_free (card->description);
+  g_array_free (card->profiles, TRUE);
+  g_free (card->active_profile);
+
+  (*G_OBJECT_CLASS (pulseaudio_card_parent_class)->finalize) (object);
+}
+
+
+
+guint32
+pulseaudio_card_get_index (PulseaudioCard *card)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_CARD (card), PA_INVALID_INDEX);
+
+  return card->index;
+}
+
+
+
+const gchar *
+pulseaudio_card_get_name (PulseaudioCard *card)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_CARD (card), NULL);
+
+  return card->name;
+}
+
+
+
+const gchar *
+pulseaudio_card_get_description (PulseaudioCard *card)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_CARD (card), NULL);
+
+  return (card->description != NULL) ? card->description : card->name;
+}
+
+
+
+guint
+pulseaudio_card_get_n_profiles (PulseaudioCard *card)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_CARD (card), 0);
+
+  return card->profiles->len;
+}
+
+
+
+const gchar *
+pulseaudio_card_get_profile_name (PulseaudioCard *card,
+                                  guint           n)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_CARD (card), NULL);
+  g_return_val_if_fail (n < card->profiles->len, NULL);
+
+  return g_array_index (card->profiles, PulseaudioCardOption, n).name;
+}
+
+
+
+const gchar *
+pulseaudio_card_get_profile_description (PulseaudioCard *card,
+                                         guint           n)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_CARD (card), NULL);
+  g_return_val_if_fail (n < card->profiles->len, NULL);
+
+  return g_array_index (card->profiles, PulseaudioCardOption, n).description;
+}
+
+
+
+gboolean
+pulseaudio_card_get_profile_available (PulseaudioCard *card,
+                                       guint           n)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_CARD (card), FALSE);
+  g_return_val_if_fail (n < card->profiles->len, FALSE);
+
+  return g_array_index (card->profiles, PulseaudioCardOption, n).available;
+}
+
+
+
+const gchar *
+pulseaudio_card_get_active_profile (PulseaudioCard *card)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_CARD (card), NULL);
+
+  return card->active_profile;
+}
+
+
+
+/* replaces the n-th option if it differs, returns TRUE if it did */
+static gboolean
+pulseaudio_card_set_option (GArray      *options,
+                            guint        n,
+                            const gchar *name,
+                            const gchar *description,
+                            gboolean     available)
+{
+  PulseaudioCardOption *option;
+
+  if (n >= options->len)
+    g_array_set_size (options, n + 1);
+
+  option = &g_array_index (options, PulseaudioCardOption, n);
+  if (g_strcmp0 (option->name, name) == 0 &&
+      g_strcmp0 (option->description, description) == 0 &&
+      option->available == available)
+    return FALSE;
+
+  g_free (option->name);
+  g_free (option->description);
+  option->name = g_strdup (name);
+  option->description = g_strdup (description);
+  option->available = available;
+
+  return TRUE;
+}
+
+
+
+void
+pulseaudio_card_update (PulseaudioCard     *card,
+                        const pa_card_info *i)
+{
+  const gchar *description;
+  const gchar *active_profile;
+  guint        n;
+  gboolean     changed = FALSE;
+
+  g_return_if_fail (IS_PULSEAUDIO_CARD (card));
+  g_return_if_fail (i != NULL);
+
+  if (g_strcmp0 (card->name, i->name) != 0)
+    {
+      g_free (card->name);
+      card->name = g_strdup (i->name);
+      changed = TRUE;
+    }
+
+  description = pa_proplist_gets (i->proplist, PA_PROP_DEVICE_DESCRIPTION);
+  if (g_strcmp0 (card->description, description) != 0)
+    {
+      g_free (card->description);
+      card->description = g_strdup (description);
+      changed = TRUE;
+    }
+
+  for (n = 0; n < i->n_profiles; n++)
+    changed |= pulseaudio_card_set_option (card->profiles, n,
+                                           i->profiles2[n]->name,
+                                           i->profiles2[n]->description,
+                                           i->profiles2[n]->available != 0);
+  if (card->profiles->len != i->n_profiles)
+    {
+      g_array_set_size (card->profiles, i->n_profiles);
+      changed = TRUE;
+    }
+
+  active_profile = (i->active_profile2 != NULL) ? i->active_profile2->name : NULL;
+  if (g_strcmp0 (card->active_profile, active_profile) != 0)
+    {
+      g_free (card->active_profile);
+      card->active_profile = g_strdup (active_profile);
+      changed = TRUE;
+    }
+
+  if (changed)
+    g_signal_emit (G_OBJECT (card), pulseaudio_card_signals [CHANGED], 0);
+}
+
+
+
+PulseaudioCard *
+pulseaudio_card_new (guint32 index)
+{
+  PulseaudioCard *card;
+
+  card = g_object_new (TYPE_PULSEAUDIO_CARD, NULL);
+  card->index = index;
+
+  return card;
+}
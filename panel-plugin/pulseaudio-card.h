@@ -0,0 +1,58 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __PULSEAUDIO_CARD_H__
+#define __PULSEAUDIO_CARD_H__
+
+#include <glib-object.h>
+#include <pulse/pulseaudio.h>
+
+G_BEGIN_DECLS
+
+#define TYPE_PULSEAUDIO_CARD             (pulseaudio_card_get_type ())
+#define PULSEAUDIO_CARD(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), TYPE_PULSEAUDIO_CARD, PulseaudioCard))
+#define PULSEAUDIO_CARD_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass),  TYPE_PULSEAUDIO_CARD, PulseaudioCardClass))
+#define IS_PULSEAUDIO_CARD(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), TYPE_PULSEAUDIO_CARD))
+#define IS_PULSEAUDIO_CARD_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass),  TYPE_PULSEAUDIO_CARD))
+#define PULSEAUDIO_CARD_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj),  TYPE_PULSEAUDIO_CARD, PulseaudioCardClass))
+
+typedef struct          _PulseaudioCard                 PulseaudioCard;
+typedef struct          _PulseaudioCardClass            PulseaudioCardClass;
+
+GType                   pulseaudio_card_get_type        (void) G_GNUC_CONST;
+
+PulseaudioCard         *pulseaudio_card_new             (guint32             index);
+
+guint32                 pulseaudio_card_get_index       (PulseaudioCard     *card);
+const gchar            *pulseaudio_card_get_name        (PulseaudioCard     *card);
+const gchar            *pulseaudio_card_get_description (PulseaudioCard     *card);
+
+guint                   pulseaudio_card_get_n_profiles  (PulseaudioCard     *card);
+const gchar            *pulseaudio_card_get_profile_name (PulseaudioCard    *card,
+                                                         guint               n);
+const gchar            *pulseaudio_card_get_profile_description (PulseaudioCard *card,
+                                                         guint               n);
+gboolean                pulseaudio_card_get_profile_available (PulseaudioCard *card,
+                                                         guint               n);
+const gchar            *pulseaudio_card_get_active_profile (PulseaudioCard  *card);
+
+void                    pulseaudio_card_update          (PulseaudioCard     *card,
+                                                         const pa_card_info *i);
+
+G_END_DECLS
+
+#endif /* !__PULSEAUDIO_CARD_H__ */
@@ -48,6 +48,13 @@
 #define DEFAULT_ENABLE_KEYBOARD_SHORTCUTS         TRUE
 #define DEFAULT_VOLUME_STEP                       6
 #define DEFAULT_VOLUME_MAX                        153
+#define DEFAULT_SHOW_SPECTRUM                     FALSE
+#define DEFAULT_PANEL_OVERLAY                     PULSEAUDIO_OVERLAY_NONE
+#define DEFAULT_PLAY_FEEDBACK                     FALSE
+#define DEFAULT_VOLUME_CURVE                      PULSEAUDIO_CURVE_LINEAR
+#define DEFAULT_VOLUME_DB_RANGE                   60
+#define DEFAULT_VOLUME_RAMP_MS                    0
+#define DEFAULT_NOTIFY_RATE                       20
 
 
 
@@ -76,6 +83,13 @@ struct _PulseaudioConfig
   guint            volume_step;
   guint            volume_max;
   gchar           *mixer_command;
+  gboolean         show_spectrum;
+  guint            panel_overlay;
+  gboolean         play_feedback;
+  guint            volume_curve;
+  guint            volume_db_range;
+  guint            volume_ramp_ms;
+  guint            notify_rate;
 };
 
 
@@ -87,6 +101,13 @@ enum
     PROP_VOLUME_STEP,
     PROP_VOLUME_MAX,
     PROP_MIXER_COMMAND,
+    PROP_SHOW_SPECTRUM,
+    PROP_PANEL_OVERLAY,
+    PROP_PLAY_FEEDBACK,
+    PROP_VOLUME_CURVE,
+    PROP_VOLUME_DB_RANGE,
+    PROP_VOLUME_RAMP_MS,
+    PROP_NOTIFY_RATE,
     N_PROPERTIES,
   };
 
@@ -149,6 +170,62 @@ pulseaudio_config_class_init (PulseaudioConfigClass *klass)
                                                         G_PARAM_STATIC_STRINGS));
 
 
+  g_object_class_install_property (gobject_class,
+                                   PROP_SHOW_SPECTRUM,
+                                   g_param_spec_boolean ("show-spectrum", NULL, NULL,
+                                                         DEFAULT_SHOW_SPECTRUM,
+                                                         G_PARAM_READWRITE |
+                                                         G_PARAM_STATIC_STRINGS));
+
+
+  g_object_class_install_property (gobject_class,
+                                   PROP_PANEL_OVERLAY,
+                                   g_param_spec_uint ("panel-overlay", NULL, NULL,
+                                                      PULSEAUDIO_OVERLAY_NONE, PULSEAUDIO_OVERLAY_ARC, DEFAULT_PANEL_OVERLAY,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+
+  g_object_class_install_property (gobject_class,
+                                   PROP_PLAY_FEEDBACK,
+                                   g_param_spec_boolean ("play-feedback", NULL, NULL,
+                                                         DEFAULT_PLAY_FEEDBACK,
+                                                         G_PARAM_READWRITE |
+                                                         G_PARAM_STATIC_STRINGS));
+
+
+  g_object_class_install_property (gobject_class,
+                                   PROP_VOLUME_CURVE,
+                                   g_param_spec_uint ("volume-curve", NULL, NULL,
+                                                      PULSEAUDIO_CURVE_LINEAR, PULSEAUDIO_CURVE_DB, DEFAULT_VOLUME_CURVE,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+
+  g_object_class_install_property (gobject_class,
+                                   PROP_VOLUME_DB_RANGE,
+                                   g_param_spec_uint ("volume-db-range", NULL, NULL,
+                                                      10, 120, DEFAULT_VOLUME_DB_RANGE,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+
+  g_object_class_install_property (gobject_class,
+                                   PROP_VOLUME_RAMP_MS,
+                                   g_param_spec_uint ("volume-ramp-ms", NULL, NULL,
+                                                      0, 1000, DEFAULT_VOLUME_RAMP_MS,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+
+  g_object_class_install_property (gobject_class,
+                                   PROP_NOTIFY_RATE,
+                                   g_param_spec_uint ("notify-rate", NULL, NULL,
+                                                      1, 100, DEFAULT_NOTIFY_RATE,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+
   pulseaudio_config_signals[CONFIGURATION_CHANGED] =
     g_signal_new (g_intern_static_string ("configuration-changed"),
                   G_TYPE_FROM_CLASS (gobject_class),
@@ -167,6 +244,13 @@ pulseaudio_config_init (PulseaudioConfig *config)
   config->volume_step               = DEFAULT_VOLUME_STEP;
   config->volume_max                = DEFAULT_VOLUME_MAX;
   config->mixer_command             = g_strdup (DEFAULT_MIXER_COMMAND);
+  config->show_spectrum             = DEFAULT_SHOW_SPECTRUM;
+  config->panel_overlay             = DEFAULT_PANEL_OVERLAY;
+  config->play_feedback             = DEFAULT_PLAY_FEEDBACK;
+  config->volume_curve              = DEFAULT_VOLUME_CURVE;
+  config->volume_db_range           = DEFAULT_VOLUME_DB_RANGE;
+  config->volume_ramp_ms            = DEFAULT_VOLUME_RAMP_MS;
+  config->notify_rate               = DEFAULT_NOTIFY_RATE;
 }
 
 
@@ -210,6 +294,34 @@ pulseaudio_config_get_property (GObject    *object,
       g_value_set_string (value, config->mixer_command);
       break;
 
+    case PROP_SHOW_SPECTRUM:
+      g_value_set_boolean (value, config->show_spectrum);
+      break;
+
+    case PROP_PANEL_OVERLAY:
+      g_value_set_uint (value, config->panel_overlay);
+      break;
+
+    case PROP_PLAY_FEEDBACK:
+      g_value_set_boolean (value, config->play_feedback);
+      break;
+
+    case PROP_VOLUME_CURVE:
+      g_value_set_uint (value, config->volume_curve);
+      break;
+
+    case PROP_VOLUME_DB_RANGE:
+      g_value_set_uint (value, config->volume_db_range);
+      break;
+
+    case PROP_VOLUME_RAMP_MS:
+      g_value_set_uint (value, config->volume_ramp_ms);
+      break;
+
+    case PROP_NOTIFY_RATE:
+      g_value_set_uint (value, config->notify_rate);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -265,6 +377,76 @@ pulseaudio_config_set_property (GObject      *object,
       config->mixer_command = g_value_dup_string (value);
       break;
 
+    case PROP_SHOW_SPECTRUM:
+      val_bool = g_value_get_boolean (value);
+      if (config->show_spectrum != val_bool)
+        {
+          config->show_spectrum = val_bool;
+          g_object_notify (G_OBJECT (config), "show-spectrum");
+          g_signal_emit (G_OBJECT (config), pulseaudio_config_signals [CONFIGURATION_CHANGED], 0);
+        }
+      break;
+
+    case PROP_PANEL_OVERLAY:
+      val_uint = g_value_get_uint (value);
+      if (config->panel_overlay != val_uint)
+        {
+          config->panel_overlay = val_uint;
+          g_object_notify (G_OBJECT (config), "panel-overlay");
+          g_signal_emit (G_OBJECT (config), pulseaudio_config_signals [CONFIGURATION_CHANGED], 0);
+        }
+      break;
+
+    case PROP_PLAY_FEEDBACK:
+      val_bool = g_value_get_boolean (value);
+      if (config->play_feedback != val_bool)
+        {
+          config->play_feedback = val_bool;
+          g_object_notify (G_OBJECT (config), "play-feedback");
+          g_signal_emit (G_OBJECT (config), pulseaudio_config_signals [CONFIGURATION_CHANGED], 0);
+        }
+      break;
+
+    case PROP_VOLUME_CURVE:
+      val_uint = g_value_get_uint (value);
+      if (config->volume_curve != val_uint)
+        {
+          config->volume_curve = val_uint;
+          g_object_notify (G_OBJECT (config), "volume-curve");
+          g_signal_emit (G_OBJECT (config), pulseaudio_config_signals [CONFIGURATION_CHANGED], 0);
+        }
+      break;
+
+    case PROP_VOLUME_DB_RANGE:
+      val_uint = g_value_get_uint (value);
+      if (config->volume_db_range != val_uint)
+        {
+          config->volume_db_range = val_uint;
+          g_object_notify (G_OBJECT (config), "volume-db-range");
+          g_signal_emit (G_OBJECT (config), pulseaudio_config_signals [CONFIGURATION_CHANGED], 0);
+        }
+      break;
+
+    case PROP_VOLUME_RAMP_MS:
+      val_uint = g_value_get_uint (value);
+      if (config->volume_ramp_ms != val_uint)
+        {
+          config->volume_ramp_ms = val_uint;
+          g_object_notify (G_OBJECT (config), "volume-ramp-ms");
+          g_signal_emit (G_OBJECT (config), pulseaudio_config_signals [CONFIGURATION_CHANGED], 0);
+        }
+      break;
+
+    case PROP_NOTIFY_RATE:
+      val_uint = g_value_get_uint (value);
+      if (config->notify_rate != val_uint)
+        {
+          config->notify_rate = val_uint;
+          g_object_notify (G_OBJECT (config), "notify-rate");
+          g_signal_emit (G_OBJECT (config), pulseaudio_config_signals [CONFIGURATION_CHANGED], 0);
+        }
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -318,6 +500,83 @@ pulseaudio_config_get_mixer_command (PulseaudioConfig *config)
 
 
 
+gboolean
+pulseaudio_config_get_show_spectrum (PulseaudioConfig *config)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_CONFIG (config), DEFAULT_SHOW_SPECTRUM);
+
+  return config->show_spectrum;
+}
+
+
+
+
+PulseaudioOverlay
+pulseaudio_config_get_panel_overlay (PulseaudioConfig *config)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_CONFIG (config), DEFAULT_PANEL_OVERLAY);
+
+  return (PulseaudioOverlay) config->panel_overlay;
+}
+
+
+
+
+gboolean
+pulseaudio_config_get_play_feedback (PulseaudioConfig *config)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_CONFIG (config), DEFAULT_PLAY_FEEDBACK);
+
+  return config->play_feedback;
+}
+
+
+
+
+PulseaudioVolumeCurve
+pulseaudio_config_get_volume_curve (PulseaudioConfig *config)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_CONFIG (config), DEFAULT_VOLUME_CURVE);
+
+  return (PulseaudioVolumeCurve) config->volume_curve;
+}
+
+
+
+
+guint
+pulseaudio_config_get_volume_db_range (PulseaudioConfig *config)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_CONFIG (config), DEFAULT_VOLUME_DB_RANGE);
+
+  return config->volume_db_range;
+}
+
+
+
+
+guint
+pulseaudio_config_get_volume_ramp_ms (PulseaudioConfig *config)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_CONFIG (config), DEFAULT_VOLUME_RAMP_MS);
+
+  return config->volume_ramp_ms;
+}
+
+
+
+
+guint
+pulseaudio_config_get_notify_rate (PulseaudioConfig *config)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_CONFIG (config), DEFAULT_NOTIFY_RATE);
+
+  return config->notify_rate;
+}
+
+
+
+
 PulseaudioConfig *
 pulseaudio_config_new (const gchar     *property_base)
 {
@@ -347,6 +606,34 @@ pulseaudio_config_new (const gchar     *property_base)
       xfconf_g_property_bind (channel, property, G_TYPE_STRING, config, "mixer-command");
       g_free (property);
 
+      property = g_strconcat (property_base, "/show-spectrum", NULL);
+      xfconf_g_property_bind (channel, property, G_TYPE_BOOLEAN, config, "show-spectrum");
+      g_free (property);
+
+      property = g_strconcat (property_base, "/panel-overlay", NULL);
+      xfconf_g_property_bind (channel, property, G_TYPE_UINT, config, "panel-overlay");
+      g_free (property);
+
+      property = g_strconcat (property_base, "/play-feedback", NULL);
+      xfconf_g_property_bind (channel, property, G_TYPE_BOOLEAN, config, "play-feedback");
+      g_free (property);
+
+      property = g_strconcat (property_base, "/volume-curve", NULL);
+      xfconf_g_property_bind (channel, property, G_TYPE_UINT, config, "volume-curve");
+      g_free (property);
+
+      property = g_strconcat (property_base, "/volume-db-range", NULL);
+      xfconf_g_property_bind (channel, property, G_TYPE_UINT, config, "volume-db-range");
+      g_free (property);
+
+      property = g_strconcat (property_base, "/volume-ramp-ms", NULL);
+      xfconf_g_property_bind (channel, property, G_TYPE_UINT, config, "volume-ramp-ms");
+      g_free (property);
+
+      property = g_strconcat (property_base, "/notify-rate", NULL);
+      xfconf_g_property_bind (channel, property, G_TYPE_UINT, config, "notify-rate");
+      g_free (property);
+
       g_object_notify (G_OBJECT (config), "enable-keyboard-shortcuts");
       g_signal_emit (G_OBJECT (config), pulseaudio_config_signals [CONFIGURATION_CHANGED], 0);
     }
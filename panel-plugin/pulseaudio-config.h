@@ -24,6 +24,20 @@
 
 G_BEGIN_DECLS
 
+typedef enum
+{
+  PULSEAUDIO_OVERLAY_NONE,
+  PULSEAUDIO_OVERLAY_LEVEL,
+  PULSEAUDIO_OVERLAY_ARC,
+} PulseaudioOverlay;
+
+typedef enum
+{
+  PULSEAUDIO_CURVE_LINEAR,
+  PULSEAUDIO_CURVE_CUBIC,
+  PULSEAUDIO_CURVE_DB,
+} PulseaudioVolumeCurve;
+
 typedef struct _PulseaudioConfigClass PulseaudioConfigClass;
 typedef struct _PulseaudioConfig      PulseaudioConfig;
 
@@ -42,6 +56,13 @@ gboolean           pulseaudio_config_get_enable_keyboard_shortcuts  (PulseaudioC
 guint              pulseaudio_config_get_volume_step                (PulseaudioConfig     *config);
 guint              pulseaudio_config_get_volume_max                 (PulseaudioConfig     *config);
 const gchar       *pulseaudio_config_get_mixer_command              (PulseaudioConfig     *config);
+gboolean           pulseaudio_config_get_show_spectrum              (PulseaudioConfig     *config);
+PulseaudioOverlay  pulseaudio_config_get_panel_overlay              (PulseaudioConfig     *config);
+gboolean           pulseaudio_config_get_play_feedback              (PulseaudioConfig     *config);
+PulseaudioVolumeCurve pulseaudio_config_get_volume_curve            (PulseaudioConfig     *config);
+guint              pulseaudio_config_get_volume_db_range            (PulseaudioConfig     *config);
+guint              pulseaudio_config_get_volume_ramp_ms             (PulseaudioConfig     *config);
+guint              pulseaudio_config_get_notify_rate                (PulseaudioConfig     *config);
 
 G_END_DECLS
 
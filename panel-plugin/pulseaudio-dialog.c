@@ -57,6 +57,7 @@ static void              pulseaudio_dialog_build                  (PulseaudioDia
 static void              pulseaudio_dialog_help_button_clicked    (PulseaudioDialog          *dialog,
                                                                    GtkWidget                 *button);
 static void              pulseaudio_dialog_mixer_command_changed     (PulseaudioDialog          *dialog);
+static void              pulseaudio_dialog_volume_curve_changed   (PulseaudioDialog          *dialog);
 static void              pulseaudio_dialog_run_mixer              (PulseaudioDialog          *dialog,
                                                                    GtkWidget                 *widget);
 
@@ -115,6 +116,23 @@ pulseaudio_dialog_mixer_command_changed (PulseaudioDialog *dialog)
 
 
 
+static void
+pulseaudio_dialog_volume_curve_changed (PulseaudioDialog *dialog)
+{
+  GObject *object;
+
+  g_return_if_fail (GTK_IS_BUILDER (dialog));
+  g_return_if_fail (IS_PULSEAUDIO_CONFIG (dialog->config));
+
+  /* the range only applies to the decibel curve */
+  object = gtk_builder_get_object (GTK_BUILDER (dialog), "spin-volume-db-range");
+  g_return_if_fail (GTK_IS_SPIN_BUTTON (object));
+  gtk_widget_set_sensitive (GTK_WIDGET (object),
+                            pulseaudio_config_get_volume_curve (dialog->config) == PULSEAUDIO_CURVE_DB);
+}
+
+
+
 static void
 pulseaudio_dialog_run_mixer (PulseaudioDialog *dialog,
                              GtkWidget        *widget)
@@ -182,12 +200,60 @@ pulseaudio_dialog_build (PulseaudioDialog *dialog)
                               G_OBJECT (object), "active",
                               G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
 
+      object = gtk_builder_get_object (builder, "spin-notify-rate");
+      g_return_if_fail (GTK_IS_SPIN_BUTTON (object));
+      g_object_bind_property (G_OBJECT (dialog->config), "notify-rate",
+                              G_OBJECT (gtk_spin_button_get_adjustment (GTK_SPIN_BUTTON (object))), "value",
+                              G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
+
+      object = gtk_builder_get_object (builder, "checkbutton-play-feedback");
+      g_return_if_fail (GTK_IS_CHECK_BUTTON (object));
+      g_object_bind_property (G_OBJECT (dialog->config), "play-feedback",
+                              G_OBJECT (object), "active",
+                              G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
+
       object = gtk_builder_get_object (builder, "entry-mixer-command");
       g_return_if_fail (GTK_IS_ENTRY (object));
       g_object_bind_property (G_OBJECT (dialog->config), "mixer-command",
                               G_OBJECT (object), "text",
                               G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
 
+      object = gtk_builder_get_object (builder, "checkbutton-show-spectrum");
+      g_return_if_fail (GTK_IS_CHECK_BUTTON (object));
+      g_object_bind_property (G_OBJECT (dialog->config), "show-spectrum",
+                              G_OBJECT (object), "active",
+                              G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
+
+      /* the items are in the order of PulseaudioOverlay */
+      object = gtk_builder_get_object (builder, "combo-panel-overlay");
+      g_return_if_fail (GTK_IS_COMBO_BOX (object));
+      g_object_bind_property (G_OBJECT (dialog->config), "panel-overlay",
+                              G_OBJECT (object), "active",
+                              G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
+
+      /* the items are in the order of PulseaudioVolumeCurve */
+      object = gtk_builder_get_object (builder, "combo-volume-curve");
+      g_return_if_fail (GTK_IS_COMBO_BOX (object));
+      g_object_bind_property (G_OBJECT (dialog->config), "volume-curve",
+                              G_OBJECT (object), "active",
+                              G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
+
+      object = gtk_builder_get_object (builder, "spin-volume-db-range");
+      g_return_if_fail (GTK_IS_SPIN_BUTTON (object));
+      g_object_bind_property (G_OBJECT (dialog->config), "volume-db-range",
+                              G_OBJECT (gtk_spin_button_get_adjustment (GTK_SPIN_BUTTON (object))), "value",
+                              G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
+      g_signal_connect_swapped (G_OBJECT (dialog->config), "notify::volume-curve",
+                                G_CALLBACK (pulseaudio_dialog_volume_curve_changed),
+                                dialog);
+      pulseaudio_dialog_volume_curve_changed (dialog);
+
+      object = gtk_builder_get_object (builder, "spin-volume-ramp-ms");
+      g_return_if_fail (GTK_IS_SPIN_BUTTON (object));
+      g_object_bind_property (G_OBJECT (dialog->config), "volume-ramp-ms",
+                              G_OBJECT (gtk_spin_button_get_adjustment (GTK_SPIN_BUTTON (object))), "value",
+                              G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
+
       object = gtk_builder_get_object (builder, "button-run-mixer");
       g_return_if_fail (GTK_IS_BUTTON (object));
       g_signal_connect_swapped (G_OBJECT (dialog->config), "notify::mixer-command",
@@ -0,0 +1,427 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+
+/*
+ *  This file implements a process-wide cache of pre-rendered volume
+ *  level icons. Surfaces are keyed by level, pixel size, scale factor
+ *  and the foreground colour used for symbolic recolouring, and are
+ *  dropped when the icon theme or the Gtk theme changes.
+ *
+ *  It also keeps a small LRU of resolved application names and icons
+ *  for the stream rows, keyed by the identifying client properties.
+ *
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <libxfce4util/libxfce4util.h>
+
+#include "pulseaudio-debug.h"
+#include "pulseaudio-icons.h"
+
+
+/* Icons for different volume levels */
+static const char *icons[] = {
+  "audio-volume-muted-symbolic",
+  "audio-volume-low-symbolic",
+  "audio-volume-medium-symbolic",
+  "audio-volume-high-symbolic",
+  NULL
+};
+
+
+typedef struct
+{
+  PulseaudioIconLevel  level;
+  gint                 size;
+  gint                 scale;
+  guint32              color;
+} PulseaudioIconKey;
+
+
+static GHashTable *icon_cache = NULL;
+static guint       icon_cache_serial = 1;
+
+
+/* Number of applications remembered */
+#define APP_CACHE_SIZE 32
+
+/* Used when neither the icon name nor the binary name resolve */
+#define APP_FALLBACK_ICON "applications-multimedia"
+
+typedef struct
+{
+  gchar               *binary;
+  gchar               *app_id;
+} PulseaudioAppKey;
+
+typedef struct
+{
+  PulseaudioAppKey     key;
+  gchar               *display_name;
+  cairo_surface_t     *surface;
+  gboolean             resolved;
+  gint                 size;
+  gint                 scale;
+  GList               *link;
+} PulseaudioAppEntry;
+
+
+static GHashTable *app_cache = NULL;
+/* Most recently used entries first */
+static GQueue      app_lru = G_QUEUE_INIT;
+
+
+
+static guint
+pulseaudio_icons_key_hash (gconstpointer data)
+{
+  const PulseaudioIconKey *key = data;
+
+  return (key->level | (key->size << 2) | (key->scale << 12)) ^ key->color;
+}
+
+
+
+static gboolean
+pulseaudio_icons_key_equal (gconstpointer a,
+                            gconstpointer b)
+{
+  const PulseaudioIconKey *key_a = a;
+  const PulseaudioIconKey *key_b = b;
+
+  return (key_a->level == key_b->level &&
+          key_a->size  == key_b->size &&
+          key_a->scale == key_b->scale &&
+          key_a->color == key_b->color);
+}
+
+
+
+static guint32
+pulseaudio_icons_pack_color (const GdkRGBA *rgba)
+{
+  return (((guint32) (rgba->red   * 255.0) & 0xff) << 24 |
+          ((guint32) (rgba->green * 255.0) & 0xff) << 16 |
+          ((guint32) (rgba->blue  * 255.0) & 0xff) << 8  |
+          ((guint32) (rgba->alpha * 255.0) & 0xff));
+}
+
+
+
+static void
+pulseaudio_icons_init_cache (void)
+{
+  if (G_LIKELY (icon_cache != NULL))
+    return;
+
+  icon_cache = g_hash_table_new_full (pulseaudio_icons_key_hash,
+                                      pulseaudio_icons_key_equal,
+                                      g_free,
+                                      (GDestroyNotify) cairo_surface_destroy);
+
+  g_signal_connect_swapped (G_OBJECT (gtk_icon_theme_get_default ()), "changed",
+                            G_CALLBACK (pulseaudio_icons_invalidate), NULL);
+  g_signal_connect_swapped (G_OBJECT (gtk_settings_get_default ()), "notify::gtk-theme-name",
+                            G_CALLBACK (pulseaudio_icons_invalidate), NULL);
+}
+
+
+
+static guint
+pulseaudio_icons_app_key_hash (gconstpointer data)
+{
+  const PulseaudioAppKey *key = data;
+
+  return (g_str_hash (key->binary != NULL ? key->binary : "") * 31 +
+          g_str_hash (key->app_id != NULL ? key->app_id : ""));
+}
+
+
+
+static gboolean
+pulseaudio_icons_app_key_equal (gconstpointer a,
+                                gconstpointer b)
+{
+  const PulseaudioAppKey *key_a = a;
+  const PulseaudioAppKey *key_b = b;
+
+  return (g_strcmp0 (key_a->binary, key_b->binary) == 0 &&
+          g_strcmp0 (key_a->app_id, key_b->app_id) == 0);
+}
+
+
+
+static void
+pulseaudio_icons_app_entry_free (gpointer data)
+{
+  PulseaudioAppEntry *entry = data;
+
+  g_free (entry->key.binary);
+  g_free (entry->key.app_id);
+  g_free (entry->display_name);
+  if (entry->surface != NULL)
+    cairo_surface_destroy (entry->surface);
+  g_slice_free (PulseaudioAppEntry, entry);
+}
+
+
+
+static void
+pulseaudio_icons_init_app_cache (void)
+{
+  if (G_LIKELY (app_cache != NULL))
+    return;
+
+  /* the key is embedded in the entry, only the value is freed */
+  app_cache = g_hash_table_new_full (pulseaudio_icons_app_key_hash,
+                                     pulseaudio_icons_app_key_equal,
+                                     NULL,
+                                     pulseaudio_icons_app_entry_free);
+
+  /* the icon cache owns the theme change handlers */
+  pulseaudio_icons_init_cache ();
+}
+
+
+
+PulseaudioIconLevel
+pulseaudio_icons_get_level (gdouble  volume,
+                            gboolean muted)
+{
+  if (muted)
+    return PULSEAUDIO_ICON_MUTED;
+  else if (volume <= 0.0)
+    return PULSEAUDIO_ICON_MUTED;
+  else if (volume <= 0.3)
+    return PULSEAUDIO_ICON_LOW;
+  else if (volume <= 0.7)
+    return PULSEAUDIO_ICON_MEDIUM;
+  else
+    return PULSEAUDIO_ICON_HIGH;
+}
+
+
+
+const gchar *
+pulseaudio_icons_get_name (PulseaudioIconLevel level)
+{
+  g_return_val_if_fail (level < PULSEAUDIO_N_ICONS, NULL);
+
+  return icons[level];
+}
+
+
+
+/* Returns a surface owned by the cache; callers that keep it across
+ * a theme change must take their own reference. */
+cairo_surface_t *
+pulseaudio_icons_get_surface (GtkWidget           *widget,
+                              PulseaudioIconLevel  level,
+                              gint                 size)
+{
+  PulseaudioIconKey  key;
+  GtkStyleContext   *context;
+  GdkRGBA            fg;
+  GtkIconInfo       *info;
+  GdkPixbuf         *pixbuf;
+  cairo_surface_t   *surface;
+
+  g_return_val_if_fail (GTK_IS_WIDGET (widget), NULL);
+  g_return_val_if_fail (level < PULSEAUDIO_N_ICONS, NULL);
+  g_return_val_if_fail (size > 0, NULL);
+
+  pulseaudio_icons_init_cache ();
+
+  context = gtk_widget_get_style_context (widget);
+  gtk_style_context_get_color (context, gtk_widget_get_state_flags (widget), &fg);
+
+  key.level = level;
+  key.size = size;
+  key.scale = gtk_widget_get_scale_factor (widget);
+  key.color = pulseaudio_icons_pack_color (&fg);
+
+  surface = g_hash_table_lookup (icon_cache, &key);
+  if (surface != NULL)
+    return surface;
+
+  info = gtk_icon_theme_lookup_icon_for_scale (gtk_icon_theme_get_default (),
+                                               icons[level], size, key.scale,
+                                               GTK_ICON_LOOKUP_FORCE_SIZE);
+  if (info == NULL)
+    return NULL;
+
+  pixbuf = gtk_icon_info_load_symbolic_for_context (info, context, NULL, NULL);
+  g_object_unref (G_OBJECT (info));
+  if (pixbuf == NULL)
+    return NULL;
+
+  surface = gdk_cairo_surface_create_from_pixbuf (pixbuf, key.scale, gtk_widget_get_window (widget));
+  g_object_unref (G_OBJECT (pixbuf));
+
+  pulseaudio_debug ("Rendered icon %s at %dpx (scale %d)", icons[level], size, key.scale);
+  g_hash_table_insert (icon_cache, g_memdup (&key, sizeof (key)), surface);
+
+  return surface;
+}
+
+
+
+static cairo_surface_t *
+pulseaudio_icons_render_app_icon (GtkWidget   *widget,
+                                  const gchar *icon_name,
+                                  const gchar *binary,
+                                  gint         size,
+                                  gint         scale)
+{
+  GtkIconTheme    *theme;
+  GtkIconInfo     *info = NULL;
+  GdkPixbuf       *pixbuf;
+  cairo_surface_t *surface;
+
+  theme = gtk_icon_theme_get_default ();
+
+  if (icon_name != NULL)
+    info = gtk_icon_theme_lookup_icon_for_scale (theme, icon_name, size, scale, GTK_ICON_LOOKUP_FORCE_SIZE);
+  if (info == NULL && binary != NULL)
+    info = gtk_icon_theme_lookup_icon_for_scale (theme, binary, size, scale, GTK_ICON_LOOKUP_FORCE_SIZE);
+  if (info == NULL)
+    info = gtk_icon_theme_lookup_icon_for_scale (theme, APP_FALLBACK_ICON, size, scale, GTK_ICON_LOOKUP_FORCE_SIZE);
+  if (info == NULL)
+    return NULL;
+
+  pixbuf = gtk_icon_info_load_icon (info, NULL);
+  g_object_unref (G_OBJECT (info));
+  if (pixbuf == NULL)
+    return NULL;
+
+  surface = gdk_cairo_surface_create_from_pixbuf (pixbuf, scale, gtk_widget_get_window (widget));
+  g_object_unref (G_OBJECT (pixbuf));
+
+  return surface;
+}
+
+
+
+/* Resolves the display name and icon of an application, cached per
+ * binary and application id. The display name is name when it is set;
+ * otherwise it and the icon are owned by the cache and stay valid until
+ * the next lookup. */
+void
+pulseaudio_icons_lookup_app (GtkWidget        *widget,
+                             const gchar      *name,
+                             const gchar      *icon_name,
+                             const gchar      *binary,
+                             const gchar      *app_id,
+                             gint              size,
+                             const gchar     **display_name,
+                             cairo_surface_t **surface)
+{
+  PulseaudioAppKey    key;
+  PulseaudioAppEntry *entry;
+  gint                scale;
+
+  g_return_if_fail (GTK_IS_WIDGET (widget));
+  g_return_if_fail (size > 0);
+
+  pulseaudio_icons_init_app_cache ();
+
+  key.binary = (gchar *) binary;
+  key.app_id = (gchar *) app_id;
+  scale = gtk_widget_get_scale_factor (widget);
+
+  entry = g_hash_table_lookup (app_cache, &key);
+  if (entry != NULL)
+    {
+      g_queue_unlink (&app_lru, entry->link);
+      g_queue_push_head_link (&app_lru, entry->link);
+    }
+  else
+    {
+      entry = g_slice_new0 (PulseaudioAppEntry);
+      entry->key.binary = g_strdup (binary);
+      entry->key.app_id = g_strdup (app_id);
+
+      if (binary != NULL)
+        entry->display_name = g_path_get_basename (binary);
+      else
+        entry->display_name = g_strdup (_("Unknown application"));
+
+      g_queue_push_head (&app_lru, entry);
+      entry->link = g_queue_peek_head_link (&app_lru);
+      g_hash_table_insert (app_cache, &entry->key, entry);
+
+      if (g_queue_get_length (&app_lru) > APP_CACHE_SIZE)
+        {
+          PulseaudioAppEntry *last = g_queue_pop_tail (&app_lru);
+          g_hash_table_remove (app_cache, &last->key);
+        }
+    }
+
+  /* an icon that did not resolve is remembered as well, the misses are
+   * the expensive lookups */
+  if (!entry->resolved || entry->size != size || entry->scale != scale)
+    {
+      if (entry->surface != NULL)
+        cairo_surface_destroy (entry->surface);
+      entry->surface = pulseaudio_icons_render_app_icon (widget, icon_name, binary, size, scale);
+      entry->resolved = TRUE;
+      entry->size = size;
+      entry->scale = scale;
+      pulseaudio_debug ("Rendered application icon for %s at %dpx (scale %d)",
+                        entry->display_name, size, scale);
+    }
+
+  if (display_name != NULL)
+    *display_name = (name != NULL) ? name : entry->display_name;
+  if (surface != NULL)
+    *surface = entry->surface;
+}
+
+
+
+/* Changes whenever the cached surfaces are dropped */
+guint
+pulseaudio_icons_get_serial (void)
+{
+  return icon_cache_serial;
+}
+
+
+
+void
+pulseaudio_icons_invalidate (void)
+{
+  icon_cache_serial++;
+
+  if (icon_cache != NULL)
+    g_hash_table_remove_all (icon_cache);
+
+  if (app_cache != NULL)
+    {
+      g_queue_clear (&app_lru);
+      g_hash_table_remove_all (app_cache);
+    }
+}
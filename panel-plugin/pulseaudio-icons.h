@@ -0,0 +1,59 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __PULSEAUDIO_ICONS_H__
+#define __PULSEAUDIO_ICONS_H__
+
+#include <glib.h>
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+  PULSEAUDIO_ICON_MUTED,
+  PULSEAUDIO_ICON_LOW,
+  PULSEAUDIO_ICON_MEDIUM,
+  PULSEAUDIO_ICON_HIGH,
+  PULSEAUDIO_N_ICONS
+} PulseaudioIconLevel;
+
+PulseaudioIconLevel     pulseaudio_icons_get_level        (gdouble              volume,
+                                                           gboolean             muted);
+
+const gchar            *pulseaudio_icons_get_name         (PulseaudioIconLevel  level);
+
+cairo_surface_t        *pulseaudio_icons_get_surface      (GtkWidget           *widget,
+                                                           PulseaudioIconLevel  level,
+                                                           gint                 size);
+
+void                    pulseaudio_icons_lookup_app       (GtkWidget           *widget,
+                                                           const gchar         *name,
+                                                           const gchar         *icon_name,
+                                                           const gchar         *binary,
+                                                           const gchar         *app_id,
+                                                           gint                 size,
+                                                           const gchar        **display_name,
+                                                           cairo_surface_t    **surface);
+
+guint                   pulseaudio_icons_get_serial       (void);
+
+void                    pulseaudio_icons_invalidate       (void);
+
+G_END_DECLS
+
+#endif /* !__PULSEAUDIO_ICONS_H__ */
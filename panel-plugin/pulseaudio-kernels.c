@@ -0,0 +1,358 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+
+/*
+ *  This file implements the sample reductions used by the meters:
+ *  per-channel absolute maximum and sum of squares over interleaved
+ *  float buffers. Vectorised versions are picked once at runtime and
+ *  fall back to the scalar loop when the channel count does not divide
+ *  the vector width.
+ *
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_MATH_H
+#include <math.h>
+#endif
+
+#include <glib.h>
+
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define PULSEAUDIO_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined (__ARM_NEON) || defined (__ARM_NEON__)
+#define PULSEAUDIO_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include "pulseaudio-debug.h"
+#include "pulseaudio-kernels.h"
+
+
+typedef struct
+{
+  const gchar          *name;
+  PulseaudioKernelFunc  func;
+  guint                 width;
+} PulseaudioKernel;
+
+
+/* Variants the CPU supports, scalar first and the preferred one last */
+static PulseaudioKernel      kernels[4];
+static guint                 n_kernels = 0;
+
+static PulseaudioKernelFunc  kernel_func = NULL;
+static guint                 kernel_width = 1;
+static const gchar          *kernel_name = NULL;
+
+
+
+static void
+pulseaudio_kernels_reduce_scalar (const gfloat *samples,
+                                  gsize         n_frames,
+                                  guint         channels,
+                                  gfloat       *peak,
+                                  gfloat       *sumsq)
+{
+  gsize  i;
+  guint  ch;
+  gfloat v;
+
+  for (ch = 0; ch < channels; ch++)
+    {
+      peak[ch] = 0.0f;
+      sumsq[ch] = 0.0f;
+    }
+
+  for (i = 0; i < n_frames; i++)
+    for (ch = 0; ch < channels; ch++)
+      {
+        v = fabsf (samples[i * channels + ch]);
+        peak[ch] = MAX (peak[ch], v);
+        sumsq[ch] += v * v;
+      }
+}
+
+
+
+/* folds the lanes of a vector accumulator into per-channel results;
+ * lane j always holds channel j % channels */
+static void
+pulseaudio_kernels_fold (const gfloat *lane_max,
+                         const gfloat *lane_sum,
+                         guint         width,
+                         guint         channels,
+                         gfloat       *peak,
+                         gfloat       *sumsq)
+{
+  guint j;
+
+  for (j = 0; j < channels; j++)
+    {
+      peak[j] = 0.0f;
+      sumsq[j] = 0.0f;
+    }
+
+  for (j = 0; j < width; j++)
+    {
+      peak[j % channels] = MAX (peak[j % channels], lane_max[j]);
+      sumsq[j % channels] += lane_sum[j];
+    }
+}
+
+
+
+static void
+pulseaudio_kernels_tail (const gfloat *samples,
+                         gsize         start,
+                         gsize         n,
+                         guint         channels,
+                         gfloat       *peak,
+                         gfloat       *sumsq)
+{
+  gsize  i;
+  gfloat v;
+
+  for (i = start; i < n; i++)
+    {
+      v = fabsf (samples[i]);
+      peak[i % channels] = MAX (peak[i % channels], v);
+      sumsq[i % channels] += v * v;
+    }
+}
+
+
+
+#ifdef PULSEAUDIO_KERNELS_X86
+__attribute__ ((target ("sse2")))
+static void
+pulseaudio_kernels_reduce_sse2 (const gfloat *samples,
+                                gsize         n_frames,
+                                guint         channels,
+                                gfloat       *peak,
+                                gfloat       *sumsq)
+{
+  const __m128 sign = _mm_set1_ps (-0.0f);
+  __m128       vmax = _mm_setzero_ps ();
+  __m128       vsum = _mm_setzero_ps ();
+  __m128       v;
+  gfloat       lane_max[4];
+  gfloat       lane_sum[4];
+  gsize        n = n_frames * channels;
+  gsize        i;
+
+  for (i = 0; i + 4 <= n; i += 4)
+    {
+      v = _mm_andnot_ps (sign, _mm_loadu_ps (samples + i));
+      vmax = _mm_max_ps (vmax, v);
+      vsum = _mm_add_ps (vsum, _mm_mul_ps (v, v));
+    }
+
+  _mm_storeu_ps (lane_max, vmax);
+  _mm_storeu_ps (lane_sum, vsum);
+  pulseaudio_kernels_fold (lane_max, lane_sum, 4, channels, peak, sumsq);
+  pulseaudio_kernels_tail (samples, i, n, channels, peak, sumsq);
+}
+
+
+
+__attribute__ ((target ("avx2")))
+static void
+pulseaudio_kernels_reduce_avx2 (const gfloat *samples,
+                                gsize         n_frames,
+                                guint         channels,
+                                gfloat       *peak,
+                                gfloat       *sumsq)
+{
+  const __m256 sign = _mm256_set1_ps (-0.0f);
+  __m256       vmax = _mm256_setzero_ps ();
+  __m256       vsum = _mm256_setzero_ps ();
+  __m256       v;
+  gfloat       lane_max[8];
+  gfloat       lane_sum[8];
+  gsize        n = n_frames * channels;
+  gsize        i;
+
+  for (i = 0; i + 8 <= n; i += 8)
+    {
+      v = _mm256_andnot_ps (sign, _mm256_loadu_ps (samples + i));
+      vmax = _mm256_max_ps (vmax, v);
+      vsum = _mm256_add_ps (vsum, _mm256_mul_ps (v, v));
+    }
+
+  _mm256_storeu_ps (lane_max, vmax);
+  _mm256_storeu_ps (lane_sum, vsum);
+  pulseaudio_kernels_fold (lane_max, lane_sum, 8, channels, peak, sumsq);
+  pulseaudio_kernels_tail (samples, i, n, channels, peak, sumsq);
+}
+#endif
+
+
+
+#ifdef PULSEAUDIO_KERNELS_NEON
+static void
+pulseaudio_kernels_reduce_neon (const gfloat *samples,
+                                gsize         n_frames,
+                                guint         channels,
+                                gfloat       *peak,
+                                gfloat       *sumsq)
+{
+  float32x4_t  vmax = vdupq_n_f32 (0.0f);
+  float32x4_t  vsum = vdupq_n_f32 (0.0f);
+  float32x4_t  v;
+  gfloat       lane_max[4];
+  gfloat       lane_sum[4];
+  gsize        n = n_frames * channels;
+  gsize        i;
+
+  for (i = 0; i + 4 <= n; i += 4)
+    {
+      v = vabsq_f32 (vld1q_f32 (samples + i));
+      vmax = vmaxq_f32 (vmax, v);
+      vsum = vmlaq_f32 (vsum, v, v);
+    }
+
+  vst1q_f32 (lane_max, vmax);
+  vst1q_f32 (lane_sum, vsum);
+  pulseaudio_kernels_fold (lane_max, lane_sum, 4, channels, peak, sumsq);
+  pulseaudio_kernels_tail (samples, i, n, channels, peak, sumsq);
+}
+#endif
+
+
+
+static void
+pulseaudio_kernels_add (const gchar          *name,
+                        PulseaudioKernelFunc  func,
+                        guint                 width)
+{
+  g_assert (n_kernels < G_N_ELEMENTS (kernels));
+
+  kernels[n_kernels].name = name;
+  kernels[n_kernels].func = func;
+  kernels[n_kernels].width = width;
+  n_kernels++;
+}
+
+
+
+static void
+pulseaudio_kernels_init (void)
+{
+  static gsize initialized = 0;
+
+  if (!g_once_init_enter (&initialized))
+    return;
+
+  pulseaudio_kernels_add ("scalar", pulseaudio_kernels_reduce_scalar, 1);
+
+#ifdef PULSEAUDIO_KERNELS_X86
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("sse2"))
+    pulseaudio_kernels_add ("sse2", pulseaudio_kernels_reduce_sse2, 4);
+  if (__builtin_cpu_supports ("avx2"))
+    pulseaudio_kernels_add ("avx2", pulseaudio_kernels_reduce_avx2, 8);
+#endif
+
+#ifdef PULSEAUDIO_KERNELS_NEON
+  pulseaudio_kernels_add ("neon", pulseaudio_kernels_reduce_neon, 4);
+#endif
+
+  kernel_func = kernels[n_kernels - 1].func;
+  kernel_width = kernels[n_kernels - 1].width;
+  kernel_name = kernels[n_kernels - 1].name;
+
+  pulseaudio_debug ("Using %s sample kernels", kernel_name);
+
+  g_once_init_leave (&initialized, 1);
+}
+
+
+
+/* Computes the absolute peak and the sum of squares of each channel of
+ * an interleaved buffer. peak and sumsq must hold channels values. */
+void
+pulseaudio_kernels_reduce (const gfloat *samples,
+                           gsize         n_frames,
+                           guint         channels,
+                           gfloat       *peak,
+                           gfloat       *sumsq)
+{
+  g_return_if_fail (samples != NULL || n_frames == 0);
+  g_return_if_fail (channels > 0);
+  g_return_if_fail (peak != NULL && sumsq != NULL);
+
+  pulseaudio_kernels_init ();
+
+  /* a buffer shorter than a vector, like the single value of a peak
+   * detecting stream, is cheaper without the lane fold */
+  if (kernel_width % channels == 0 && n_frames * channels >= kernel_width)
+    kernel_func (samples, n_frames, channels, peak, sumsq);
+  else
+    pulseaudio_kernels_reduce_scalar (samples, n_frames, channels, peak, sumsq);
+}
+
+
+
+const gchar *
+pulseaudio_kernels_get_name (void)
+{
+  pulseaudio_kernels_init ();
+
+  return kernel_name;
+}
+
+
+
+/* The variants this CPU can run, for tests and benchmarks. Variant 0
+ * is the scalar reference; a variant of width w only handles channel
+ * counts that divide w. */
+guint
+pulseaudio_kernels_get_n_variants (void)
+{
+  pulseaudio_kernels_init ();
+
+  return n_kernels;
+}
+
+
+
+const gchar *
+pulseaudio_kernels_get_variant (guint                 n,
+                                PulseaudioKernelFunc *func,
+                                guint                *width)
+{
+  pulseaudio_kernels_init ();
+
+  g_return_val_if_fail (n < n_kernels, NULL);
+
+  if (func != NULL)
+    *func = kernels[n].func;
+  if (width != NULL)
+    *width = kernels[n].width;
+
+  return kernels[n].name;
+}
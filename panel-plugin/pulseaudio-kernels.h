@@ -0,0 +1,46 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __PULSEAUDIO_KERNELS_H__
+#define __PULSEAUDIO_KERNELS_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef void (*PulseaudioKernelFunc) (const gfloat *samples,
+                                      gsize         n_frames,
+                                      guint         channels,
+                                      gfloat       *peak,
+                                      gfloat       *sumsq);
+
+void                    pulseaudio_kernels_reduce         (const gfloat *samples,
+                                                           gsize         n_frames,
+                                                           guint         channels,
+                                                           gfloat       *peak,
+                                                           gfloat       *sumsq);
+
+const gchar            *pulseaudio_kernels_get_name       (void);
+
+guint                   pulseaudio_kernels_get_n_variants (void);
+const gchar            *pulseaudio_kernels_get_variant    (guint                 n,
+                                                           PulseaudioKernelFunc *func,
+                                                           guint                *width);
+
+G_END_DECLS
+
+#endif /* !__PULSEAUDIO_KERNELS_H__ */
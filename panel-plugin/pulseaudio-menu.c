@@ -25,15 +25,56 @@
 
 
 
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_MATH_H
+#include <math.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
 #include <glib.h>
 #include <gtk/gtk.h>
 #include <libxfce4panel/libxfce4panel.h>
 #include <libxfce4util/libxfce4util.h>
 #include <libxfce4ui/libxfce4ui.h>
 
+#include "pulseaudio-debug.h"
 #include "pulseaudio-menu.h"
+#include "pulseaudio-icons.h"
+#include "pulseaudio-spectrum.h"
 #include "scalemenuitem.h"
 
+#define MENU_ICON_SIZE 24
+
+/* Peak meter updates per second */
+#define METER_RATE 25
+
+/* Most playback streams metered at once */
+#define STREAM_METERS_MAX 6
+/* A stream silent for this long may lose its meter to another one */
+#define STREAM_METER_IDLE (2 * G_USEC_PER_SEC)
+/* How often meters are reassigned */
+#define STREAM_METER_CHECK (G_USEC_PER_SEC / 2)
+
+/* Latency samples kept for the sparkline, one per second */
+#define LATENCY_HISTORY 60
+#define LATENCY_INTERVAL 1
+
+
+/* A slot of the fixed stream meter pool */
+typedef struct
+{
+  GtkWidget            *row;
+  PulseaudioMeter      *meter;
+  guint32               device;
+  gint64                last_active;
+} PulseaudioMenuStreamMeter;
+
 
 struct _PulseaudioMenu
 {
@@ -42,8 +83,64 @@ struct _PulseaudioMenu
   PulseaudioVolume     *volume;
   PulseaudioConfig     *config;
   GtkWidget            *button;
+  GtkWidget            *output_item;
   GtkWidget            *range_output;
+  GtkWidget            *image_output;
   GtkWidget            *mute_output_item;
+  GtkWidget            *meter_box;
+  GtkWidget            *meter_bar;
+  GtkWidget            *spectrum;
+  GtkWidget            *sinks_header;
+
+  /* One row per entry of the sink registry, in model order */
+  GPtrArray            *sink_rows;
+
+  /* Latency of the default sink, sampled only while mapped */
+  GtkWidget            *latency_item;
+  GtkWidget            *latency_label;
+  GtkWidget            *latency_graph;
+  gdouble               latency_history[LATENCY_HISTORY];
+  guint                 latency_head;
+  guint                 latency_count;
+  guint                 latency_timeout_id;
+
+  /* Card profiles and ports, filled when shown */
+  GtkWidget            *cards_item;
+  GtkWidget            *cards_menu;
+
+  /* Same for the playback streams (sink inputs) */
+  GtkWidget            *streams_header;
+  GPtrArray            *stream_rows;
+
+  /* Submenu for moving streams between devices, filled when shown */
+  GtkWidget            *move_item;
+  GtkWidget            *move_menu;
+
+  /* Applications recording (source outputs), in model order */
+  GtkWidget            *recording_header;
+  GPtrArray            *recording_rows;
+
+  PulseaudioIconLevel   image_level;
+
+  /* Volume changed while the menu was not mapped */
+  gboolean              update_pending;
+
+  /* Scroll steps collected during the current frame */
+  gint                  scroll_steps;
+  guint                 scroll_tick_id;
+
+  /* Peak meter, only exists while the menu is mapped */
+  PulseaudioMeter      *meter;
+  guint                 meter_tick_id;
+  gint64                meter_started;
+  gint64                meter_busy;
+  guint                 meter_ticks;
+
+  /* Meters on stream rows, a row without a slot shows no meter */
+  PulseaudioMenuStreamMeter stream_meters[STREAM_METERS_MAX];
+  gint64                stream_meters_checked;
+  guint                 stream_meters_started;
+  guint                 stream_meters_evicted;
 
   gulong                volume_changed_id;
 };
@@ -55,6 +152,10 @@ struct _PulseaudioMenuClass
 
 
 static void             pulseaudio_menu_finalize         (GObject       *object);
+static void             pulseaudio_menu_map              (GtkWidget     *widget);
+static void             pulseaudio_menu_unmap            (GtkWidget     *widget);
+static void             pulseaudio_menu_volume_changed   (PulseaudioMenu   *menu,
+                                                          PulseaudioVolume *volume);
 
 
 G_DEFINE_TYPE (PulseaudioMenu, pulseaudio_menu, GTK_TYPE_MENU)
@@ -63,9 +164,14 @@ static void
 pulseaudio_menu_class_init (PulseaudioMenuClass *klass)
 {
   GObjectClass      *gobject_class;
+  GtkWidgetClass    *gtkwidget_class;
 
   gobject_class = G_OBJECT_CLASS (klass);
   gobject_class->finalize = pulseaudio_menu_finalize;
+
+  gtkwidget_class = GTK_WIDGET_CLASS (klass);
+  gtkwidget_class->map = pulseaudio_menu_map;
+  gtkwidget_class->unmap = pulseaudio_menu_unmap;
 }
 
 
@@ -76,8 +182,42 @@ pulseaudio_menu_init (PulseaudioMenu *menu)
   menu->volume                         = NULL;
   menu->config                         = NULL;
   menu->button                         = NULL;
+  menu->output_item                    = NULL;
   menu->range_output                   = NULL;
+  menu->image_output                   = NULL;
   menu->mute_output_item               = NULL;
+  menu->meter_box                      = NULL;
+  menu->meter_bar                      = NULL;
+  menu->spectrum                       = NULL;
+  menu->sinks_header                   = NULL;
+  menu->sink_rows                      = g_ptr_array_new ();
+  menu->latency_item                   = NULL;
+  menu->latency_label                  = NULL;
+  menu->latency_graph                  = NULL;
+  menu->latency_head                   = 0;
+  menu->latency_count                  = 0;
+  menu->latency_timeout_id             = 0;
+  menu->cards_item                     = NULL;
+  menu->cards_menu                     = NULL;
+  menu->streams_header                 = NULL;
+  menu->stream_rows                    = g_ptr_array_new ();
+  menu->move_item                      = NULL;
+  menu->move_menu                      = NULL;
+  menu->recording_header               = NULL;
+  menu->recording_rows                 = g_ptr_array_new ();
+  menu->image_level                    = PULSEAUDIO_N_ICONS;
+  menu->update_pending                 = FALSE;
+  menu->scroll_steps                   = 0;
+  menu->scroll_tick_id                 = 0;
+  menu->meter                          = NULL;
+  menu->meter_tick_id                  = 0;
+  menu->meter_started                  = 0;
+  menu->meter_busy                     = 0;
+  menu->meter_ticks                    = 0;
+  memset (menu->stream_meters, 0, sizeof (menu->stream_meters));
+  menu->stream_meters_checked          = 0;
+  menu->stream_meters_started          = 0;
+  menu->stream_meters_evicted          = 0;
   menu->volume_changed_id              = 0;
 }
 
@@ -92,11 +232,33 @@ pulseaudio_menu_finalize (GObject *object)
   if (menu->volume_changed_id != 0)
     g_signal_handler_disconnect (G_OBJECT (menu->volume), menu->volume_changed_id);
 
+  g_ptr_array_free (menu->sink_rows, TRUE);
+  g_ptr_array_free (menu->stream_rows, TRUE);
+  g_ptr_array_free (menu->recording_rows, TRUE);
+
   menu->volume                         = NULL;
   menu->config                         = NULL;
   menu->button                         = NULL;
+  menu->output_item                    = NULL;
   menu->range_output                   = NULL;
+  menu->image_output                   = NULL;
   menu->mute_output_item               = NULL;
+  menu->meter_box                      = NULL;
+  menu->meter_bar                      = NULL;
+  menu->spectrum                       = NULL;
+  menu->sinks_header                   = NULL;
+  menu->sink_rows                      = NULL;
+  menu->latency_item                   = NULL;
+  menu->latency_label                  = NULL;
+  menu->latency_graph                  = NULL;
+  menu->cards_item                     = NULL;
+  menu->cards_menu                     = NULL;
+  menu->streams_header                 = NULL;
+  menu->stream_rows                    = NULL;
+  menu->move_item                      = NULL;
+  menu->move_menu                      = NULL;
+  menu->recording_header               = NULL;
+  menu->recording_rows                 = NULL;
   menu->volume_changed_id              = 0;
 
   G_OBJECT_CLASS (pulseaudio_menu_parent_class)->finalize (object);
@@ -104,24 +266,434 @@ pulseaudio_menu_finalize (GObject *object)
 
 
 static void
+pulseaudio_menu_stream_meter_release (PulseaudioMenuStreamMeter *slot)
+{
+  if (slot->row == NULL)
+    return;
+
+  gtk_widget_hide (g_object_get_data (G_OBJECT (slot->row), "pulseaudio-level"));
+  if (slot->meter != NULL)
+    g_object_unref (G_OBJECT (slot->meter));
+
+  slot->row = NULL;
+  slot->meter = NULL;
+}
+
+
+
+static void
+pulseaudio_menu_stream_meter_assign (PulseaudioMenu            *menu,
+                                     PulseaudioMenuStreamMeter *slot,
+                                     GtkWidget                 *row,
+                                     gint64                     now)
+{
+  PulseaudioStream *stream = g_object_get_data (G_OBJECT (row), "pulseaudio-stream");
+  GtkWidget        *bar = g_object_get_data (G_OBJECT (row), "pulseaudio-level");
+
+  slot->row = row;
+  slot->meter = pulseaudio_volume_new_stream_meter (menu->volume, stream, METER_RATE);
+  slot->device = pulseaudio_stream_get_device (stream);
+  slot->last_active = now;
+  menu->stream_meters_started++;
+
+  gtk_level_bar_set_value (GTK_LEVEL_BAR (bar), 0.0);
+  gtk_widget_show (bar);
+}
+
+
+
+/* Playing streams without a meter take a free slot, or the one of the
+ * stream that has been silent the longest. Returns FALSE when there is
+ * nothing more to do for this stream. */
+static gboolean
+pulseaudio_menu_stream_meter_acquire (PulseaudioMenu *menu,
+                                      GtkWidget      *row,
+                                      gint64          now)
+{
+  PulseaudioMenuStreamMeter *slot;
+  PulseaudioMenuStreamMeter *victim = NULL;
+  PulseaudioStream          *stream;
+  guint                      i;
+
+  for (i = 0; i < STREAM_METERS_MAX; i++)
+    {
+      slot = &menu->stream_meters[i];
+      if (slot->row == NULL)
+        {
+          pulseaudio_menu_stream_meter_assign (menu, slot, row, now);
+          return TRUE;
+        }
+
+      stream = g_object_get_data (G_OBJECT (slot->row), "pulseaudio-stream");
+      if (!pulseaudio_stream_get_corked (stream) && now - slot->last_active < STREAM_METER_IDLE)
+        continue;
+
+      if (victim == NULL || slot->last_active < victim->last_active)
+        victim = slot;
+    }
+
+  if (victim == NULL)
+    return FALSE;
+
+  pulseaudio_menu_stream_meter_release (victim);
+  pulseaudio_menu_stream_meter_assign (menu, victim, row, now);
+  menu->stream_meters_evicted++;
+
+  return TRUE;
+}
+
+
+
+static void
+pulseaudio_menu_stream_meters_update (PulseaudioMenu *menu,
+                                      gint64          now)
+{
+  PulseaudioMenuStreamMeter *slot;
+  PulseaudioStream          *stream;
+  GtkWidget                 *row;
+  gboolean                   metered;
+  guint                      i, j;
+
+  menu->stream_meters_checked = now;
+
+  /* a meter follows its stream only as long as it stays on the same sink */
+  for (i = 0; i < STREAM_METERS_MAX; i++)
+    {
+      slot = &menu->stream_meters[i];
+      if (slot->row == NULL)
+        continue;
+
+      stream = g_object_get_data (G_OBJECT (slot->row), "pulseaudio-stream");
+      if (pulseaudio_stream_get_device (stream) != slot->device)
+        pulseaudio_menu_stream_meter_release (slot);
+    }
+
+  for (i = 0; i < menu->stream_rows->len; i++)
+    {
+      row = g_ptr_array_index (menu->stream_rows, i);
+      stream = g_object_get_data (G_OBJECT (row), "pulseaudio-stream");
+      if (pulseaudio_stream_get_corked (stream))
+        continue;
+
+      metered = FALSE;
+      for (j = 0; j < STREAM_METERS_MAX && !metered; j++)
+        metered = (menu->stream_meters[j].row == row);
+
+      if (!metered && !pulseaudio_menu_stream_meter_acquire (menu, row, now))
+        break;
+    }
+}
+
+
+
+static void
+pulseaudio_menu_stream_meters_clear (PulseaudioMenu *menu)
+{
+  guint i;
+
+  for (i = 0; i < STREAM_METERS_MAX; i++)
+    pulseaudio_menu_stream_meter_release (&menu->stream_meters[i]);
+
+  if (menu->stream_meters_started > 0)
+    pulseaudio_debug ("Stream meters: %u started, %u evicted",
+                      menu->stream_meters_started, menu->stream_meters_evicted);
+
+  menu->stream_meters_checked = 0;
+  menu->stream_meters_started = 0;
+  menu->stream_meters_evicted = 0;
+}
+
+
+
+/* Runs at the meter rate rather than the frame rate, the server sends
+ * no more than METER_RATE peaks per second anyway */
+static gboolean
+pulseaudio_menu_meter_tick (gpointer user_data)
+{
+  PulseaudioMenu            *menu = PULSEAUDIO_MENU (user_data);
+  PulseaudioMenuStreamMeter *slot;
+  gdouble                    peak;
+  gint64                     now;
+  guint                      i;
+
+  now = g_get_monotonic_time ();
+
+  /* only redraw when the stream delivered something new */
+  if (menu->meter != NULL && pulseaudio_meter_take_peak (menu->meter, &peak))
+    gtk_level_bar_set_value (GTK_LEVEL_BAR (menu->meter_bar), cbrt (peak));
+
+  for (i = 0; i < STREAM_METERS_MAX; i++)
+    {
+      slot = &menu->stream_meters[i];
+      if (slot->meter == NULL || !pulseaudio_meter_take_peak (slot->meter, &peak))
+        continue;
+
+      gtk_level_bar_set_value (GTK_LEVEL_BAR (g_object_get_data (G_OBJECT (slot->row), "pulseaudio-level")),
+                               cbrt (peak));
+      if (peak > 1e-4)
+        slot->last_active = now;
+    }
+
+  if (now - menu->stream_meters_checked >= STREAM_METER_CHECK)
+    pulseaudio_menu_stream_meters_update (menu, now);
+
+  menu->meter_ticks++;
+  menu->meter_busy += g_get_monotonic_time () - now;
+
+  return G_SOURCE_CONTINUE;
+}
+
+
+
+static void
+pulseaudio_menu_meter_start (PulseaudioMenu *menu)
+{
+  menu->meter = pulseaudio_volume_new_meter (menu->volume, METER_RATE);
+  if (menu->meter == NULL)
+    return;
+
+  gtk_level_bar_set_value (GTK_LEVEL_BAR (menu->meter_bar), 0.0);
+  gtk_widget_show (menu->meter_box);
+  menu->meter_started = g_get_monotonic_time ();
+  menu->meter_busy = 0;
+  menu->meter_ticks = 0;
+  menu->meter_tick_id = g_timeout_add (1000 / METER_RATE, pulseaudio_menu_meter_tick, menu);
+}
+
+
+
+static void
+pulseaudio_menu_meter_stop (PulseaudioMenu *menu)
+{
+  gint64 elapsed;
+
+  if (menu->meter_tick_id != 0)
+    {
+      g_source_remove (menu->meter_tick_id);
+      menu->meter_tick_id = 0;
+
+      /* time spent updating the level bars, against the 0.5% budget */
+      elapsed = g_get_monotonic_time () - menu->meter_started;
+      if (elapsed > 0)
+        pulseaudio_debug ("Meter updates: %u in %.1f s, %.4f%% of a core",
+                          menu->meter_ticks, elapsed / 1e6, 100.0 * menu->meter_busy / elapsed);
+    }
+
+  if (menu->meter != NULL)
+    {
+      g_object_unref (G_OBJECT (menu->meter));
+      menu->meter = NULL;
+    }
+
+  pulseaudio_menu_stream_meters_clear (menu);
+  gtk_widget_hide (menu->meter_box);
+}
+
+
+
+static void
+pulseaudio_menu_latency_sampled (PulseaudioMenu   *menu,
+                                 PulseaudioVolume *volume)
+{
+  gdouble  latency;
+  gdouble  configured;
+  gchar   *text;
+
+  /* a reply may still arrive after the menu was closed */
+  if (menu->latency_timeout_id == 0)
+    return;
+
+  latency = pulseaudio_volume_get_sink_latency (volume) / 1000.0;
+  configured = pulseaudio_volume_get_sink_configured_latency (volume) / 1000.0;
+
+  menu->latency_history[menu->latency_head] = latency;
+  menu->latency_head = (menu->latency_head + 1) % LATENCY_HISTORY;
+  menu->latency_count = MIN (menu->latency_count + 1, LATENCY_HISTORY);
+
+  text = g_strdup_printf (_("Latency %.0f ms (configured %.0f ms)"), latency, configured);
+  gtk_label_set_text (GTK_LABEL (menu->latency_label), text);
+  g_free (text);
+
+  gtk_widget_show (menu->latency_item);
+  gtk_widget_queue_draw (menu->latency_graph);
+}
+
+
+
+static gboolean
+pulseaudio_menu_latency_timeout (gpointer user_data)
+{
+  PulseaudioMenu *menu = PULSEAUDIO_MENU (user_data);
+
+  pulseaudio_volume_sample_latency (menu->volume);
+
+  return G_SOURCE_CONTINUE;
+}
+
+
+
+static gboolean
+pulseaudio_menu_latency_draw (GtkWidget      *widget,
+                              cairo_t        *cr,
+                              PulseaudioMenu *menu)
+{
+  GtkStyleContext *context;
+  GdkRGBA          fg;
+  gdouble          width, height, step;
+  gdouble          configured;
+  gdouble          top = 1.0;
+  guint            i, n;
+
+  if (menu->latency_count == 0)
+    return FALSE;
+
+  width = gtk_widget_get_allocated_width (widget);
+  height = gtk_widget_get_allocated_height (widget);
+  step = width / (LATENCY_HISTORY - 1);
+  configured = pulseaudio_volume_get_sink_configured_latency (menu->volume) / 1000.0;
+
+  /* scale to the largest reading or the configured latency */
+  top = MAX (top, configured);
+  for (i = 0; i < menu->latency_count; i++)
+    top = MAX (top, menu->latency_history[i]);
+  top *= 1.1;
+
+  context = gtk_widget_get_style_context (widget);
+  gtk_style_context_get_color (context, gtk_widget_get_state_flags (widget), &fg);
+
+  /* configured latency as a faint reference line */
+  gdk_cairo_set_source_rgba (cr, &fg);
+  cairo_set_line_width (cr, 1.0);
+  cairo_push_group (cr);
+  cairo_move_to (cr, 0.0, height * (1.0 - configured / top));
+  cairo_line_to (cr, width, height * (1.0 - configured / top));
+  cairo_stroke (cr);
+  cairo_pop_group_to_source (cr);
+  cairo_paint_with_alpha (cr, 0.4);
+
+  /* newest sample at the right edge */
+  gdk_cairo_set_source_rgba (cr, &fg);
+  cairo_set_line_width (cr, 1.5);
+  for (i = 0; i < menu->latency_count; i++)
+    {
+      n = (menu->latency_head + LATENCY_HISTORY - menu->latency_count + i) % LATENCY_HISTORY;
+      cairo_line_to (cr,
+                     width - (menu->latency_count - 1 - i) * step,
+                     height * (1.0 - menu->latency_history[n] / top));
+    }
+  cairo_stroke (cr);
+
+  return FALSE;
+}
+
+
+
+static void
+pulseaudio_menu_latency_start (PulseaudioMenu *menu)
+{
+  menu->latency_head = 0;
+  menu->latency_count = 0;
+  menu->latency_timeout_id = g_timeout_add_seconds (LATENCY_INTERVAL, pulseaudio_menu_latency_timeout, menu);
+  pulseaudio_volume_sample_latency (menu->volume);
+}
+
+
+
+static void
+pulseaudio_menu_latency_stop (PulseaudioMenu *menu)
+{
+  if (menu->latency_timeout_id != 0)
+    {
+      g_source_remove (menu->latency_timeout_id);
+      menu->latency_timeout_id = 0;
+    }
+
+  gtk_widget_hide (menu->latency_item);
+}
+
+
+
+static void
+pulseaudio_menu_show_spectrum_changed (PulseaudioMenu *menu)
+{
+  gtk_widget_set_visible (menu->spectrum,
+                          pulseaudio_config_get_show_spectrum (menu->config));
+}
+
+
+
+static void
+pulseaudio_menu_map (GtkWidget *widget)
+{
+  PulseaudioMenu *menu = PULSEAUDIO_MENU (widget);
+
+  (*GTK_WIDGET_CLASS (pulseaudio_menu_parent_class)->map) (widget);
+
+  pulseaudio_volume_set_ui_visible (menu->volume, TRUE);
+  pulseaudio_menu_meter_start (menu);
+  pulseaudio_menu_latency_start (menu);
+
+  /* Apply the latest state recorded while unmapped */
+  if (menu->update_pending)
+    pulseaudio_menu_volume_changed (menu, menu->volume);
+}
+
+
+static void
+pulseaudio_menu_unmap (GtkWidget *widget)
+{
+  PulseaudioMenu *menu = PULSEAUDIO_MENU (widget);
+
+  pulseaudio_menu_meter_stop (menu);
+  pulseaudio_menu_latency_stop (menu);
+  pulseaudio_volume_set_ui_visible (menu->volume, FALSE);
+
+  (*GTK_WIDGET_CLASS (pulseaudio_menu_parent_class)->unmap) (widget);
+}
+
+
+static gboolean
+pulseaudio_menu_output_range_scroll_tick (GtkWidget     *widget,
+                                          GdkFrameClock *frame_clock,
+                                          gpointer       user_data)
+{
+  PulseaudioMenu *menu = PULSEAUDIO_MENU (widget);
+
+  menu->scroll_tick_id = 0;
+
+  /* A single write with the net delta of this frame, the slider
+   * reaches up to volume-max */
+  pulseaudio_volume_step_volume (menu->volume, menu->scroll_steps, TRUE);
+  menu->scroll_steps = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static gboolean
 pulseaudio_menu_output_range_scroll (GtkWidget        *widget,
                                      GdkEvent         *event,
                                      PulseaudioMenu   *menu)
 {
-  gdouble         new_volume;
-  gdouble         volume;
-  gdouble         volume_step;
   GdkEventScroll *scroll_event;
 
-  g_return_if_fail (IS_PULSEAUDIO_MENU (menu));
-  volume =  pulseaudio_volume_get_volume (menu->volume);
-  volume_step = pulseaudio_config_get_volume_step (menu->config) / 100.0;
+  g_return_val_if_fail (IS_PULSEAUDIO_MENU (menu), FALSE);
 
   scroll_event = (GdkEventScroll*)event;
 
-  new_volume = volume + (1.0 - 2.0 * scroll_event->direction) * volume_step;
-  pulseaudio_volume_set_volume (menu->volume, new_volume);
-  //printf ("scroll %d %g %g\n", scroll_event->direction, volume, new_volume);
+  if (scroll_event->direction == GDK_SCROLL_UP)
+    menu->scroll_steps++;
+  else if (scroll_event->direction == GDK_SCROLL_DOWN)
+    menu->scroll_steps--;
+  else
+    return FALSE;
+
+  if (menu->scroll_tick_id == 0)
+    menu->scroll_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (menu),
+                                                         pulseaudio_menu_output_range_scroll_tick,
+                                                         NULL, NULL);
+
+  return TRUE;
 }
 
 static void
@@ -180,6 +752,44 @@ pulseaudio_menu_run_audio_mixer (PulseaudioMenu   *menu,
 
 
 
+static void
+pulseaudio_menu_update_image (PulseaudioMenu *menu,
+                              gboolean        force_update)
+{
+  PulseaudioIconLevel  level;
+  cairo_surface_t     *surface;
+
+  g_return_if_fail (IS_PULSEAUDIO_MENU (menu));
+
+  level = pulseaudio_icons_get_level (pulseaudio_volume_get_volume (menu->volume),
+                                      pulseaudio_volume_get_muted (menu->volume));
+
+  if (!force_update && level == menu->image_level)
+    return;
+
+  menu->image_level = level;
+  surface = pulseaudio_icons_get_surface (menu->image_output, level, MENU_ICON_SIZE);
+  if (surface != NULL)
+    {
+      gtk_image_set_from_surface (GTK_IMAGE (menu->image_output), surface);
+    }
+  else
+    {
+      gtk_image_set_from_icon_name (GTK_IMAGE (menu->image_output), pulseaudio_icons_get_name (level), GTK_ICON_SIZE_DND);
+      gtk_image_set_pixel_size (GTK_IMAGE (menu->image_output), MENU_ICON_SIZE);
+    }
+}
+
+
+
+static void
+pulseaudio_menu_image_style_updated (PulseaudioMenu *menu)
+{
+  pulseaudio_menu_update_image (menu, TRUE);
+}
+
+
+
 static void
 pulseaudio_menu_volume_changed (PulseaudioMenu   *menu,
                                 PulseaudioVolume *volume)
@@ -187,6 +797,13 @@ pulseaudio_menu_volume_changed (PulseaudioMenu   *menu,
   g_return_if_fail (IS_PULSEAUDIO_MENU (menu));
   g_return_if_fail (IS_PULSEAUDIO_VOLUME (volume));
 
+  if (!gtk_widget_get_mapped (GTK_WIDGET (menu)))
+    {
+      menu->update_pending = TRUE;
+      return;
+    }
+  menu->update_pending = FALSE;
+
   g_signal_handlers_block_by_func (G_OBJECT (menu->mute_output_item),
                                    pulseaudio_menu_mute_output_item_toggled,
                                    menu);
@@ -196,7 +813,695 @@ pulseaudio_menu_volume_changed (PulseaudioMenu   *menu,
                                      pulseaudio_menu_mute_output_item_toggled,
                                      menu);
 
-  gtk_range_set_value (GTK_RANGE (menu->range_output), pulseaudio_volume_get_volume (menu->volume) * 100.0);
+  /* not through the range, its value-changed would set the volume
+   * again and cancel a running ramp */
+  scale_menu_item_set_value (SCALE_MENU_ITEM (menu->output_item),
+                             pulseaudio_volume_get_volume (menu->volume) * 100.0);
+
+  pulseaudio_menu_update_image (menu, FALSE);
+}
+
+
+
+static gint
+pulseaudio_menu_get_position (PulseaudioMenu *menu,
+                              GtkWidget      *child)
+{
+  GList *children;
+  gint   position;
+
+  children = gtk_container_get_children (GTK_CONTAINER (menu));
+  position = g_list_index (children, child);
+  g_list_free (children);
+
+  return position;
+}
+
+
+
+static void pulseaudio_menu_sink_row_toggled (GtkCheckMenuItem *row,
+                                              PulseaudioMenu   *menu);
+
+static void
+pulseaudio_menu_sink_row_update (PulseaudioSink *sink,
+                                 GtkWidget      *row)
+{
+  gchar *label;
+
+  if (pulseaudio_sink_get_muted (sink))
+    label = g_strdup_printf (_("%s (muted)"), pulseaudio_sink_get_description (sink));
+  else
+    label = g_strdup_printf (_("%s (%d%%)"), pulseaudio_sink_get_description (sink),
+                             (gint) round (pulseaudio_sink_get_volume (sink) * 100));
+  gtk_menu_item_set_label (GTK_MENU_ITEM (row), label);
+  g_free (label);
+
+  g_signal_handlers_block_matched (G_OBJECT (row), G_SIGNAL_MATCH_FUNC, 0, 0, NULL,
+                                   pulseaudio_menu_sink_row_toggled, NULL);
+  gtk_check_menu_item_set_active (GTK_CHECK_MENU_ITEM (row), pulseaudio_sink_get_default (sink));
+  g_signal_handlers_unblock_matched (G_OBJECT (row), G_SIGNAL_MATCH_FUNC, 0, 0, NULL,
+                                     pulseaudio_menu_sink_row_toggled, NULL);
+}
+
+
+
+static void
+pulseaudio_menu_sink_row_toggled (GtkCheckMenuItem *row,
+                                  PulseaudioMenu   *menu)
+{
+  PulseaudioSink *sink;
+
+  g_return_if_fail (IS_PULSEAUDIO_MENU (menu));
+
+  sink = g_object_get_data (G_OBJECT (row), "pulseaudio-sink");
+  pulseaudio_volume_set_default_sink (menu->volume, sink);
+
+  /* the check mark follows the server state */
+  pulseaudio_menu_sink_row_update (sink, GTK_WIDGET (row));
+}
+
+
+
+static GtkWidget *
+pulseaudio_menu_sink_row_new (PulseaudioMenu *menu,
+                              PulseaudioSink *sink)
+{
+  GtkWidget *row;
+
+  row = gtk_check_menu_item_new_with_label ("");
+  gtk_check_menu_item_set_draw_as_radio (GTK_CHECK_MENU_ITEM (row), TRUE);
+  g_object_set_data_full (G_OBJECT (row), "pulseaudio-sink", g_object_ref (sink), g_object_unref);
+  pulseaudio_menu_sink_row_update (sink, row);
+
+  g_signal_connect (G_OBJECT (row), "toggled",
+                    G_CALLBACK (pulseaudio_menu_sink_row_toggled), menu);
+  g_signal_connect_object (G_OBJECT (sink), "changed",
+                           G_CALLBACK (pulseaudio_menu_sink_row_update), row, 0);
+
+  gtk_widget_show (row);
+
+  return row;
+}
+
+
+
+/* adding or removing a sink only touches the affected rows */
+static void
+pulseaudio_menu_sinks_changed (GListModel     *model,
+                               guint           position,
+                               guint           removed,
+                               guint           added,
+                               PulseaudioMenu *menu)
+{
+  PulseaudioSink *sink;
+  GtkWidget      *row;
+  gint            offset;
+  guint           i;
+
+  for (i = 0; i < removed; i++)
+    {
+      row = g_ptr_array_index (menu->sink_rows, position);
+      g_ptr_array_remove_index (menu->sink_rows, position);
+      gtk_widget_destroy (row);
+    }
+
+  offset = pulseaudio_menu_get_position (menu, menu->sinks_header) + 1;
+  for (i = position; i < position + added; i++)
+    {
+      sink = g_list_model_get_item (model, i);
+      row = pulseaudio_menu_sink_row_new (menu, sink);
+      g_object_unref (G_OBJECT (sink));
+
+      g_ptr_array_insert (menu->sink_rows, i, row);
+      gtk_menu_shell_insert (GTK_MENU_SHELL (menu), row, offset + i);
+    }
+}
+
+
+
+static void
+pulseaudio_menu_card_profile_activate (GtkCheckMenuItem *item,
+                                       PulseaudioMenu   *menu)
+{
+  g_return_if_fail (IS_PULSEAUDIO_MENU (menu));
+
+  if (gtk_check_menu_item_get_active (item))
+    pulseaudio_volume_set_card_profile (menu->volume,
+                                        g_object_get_data (G_OBJECT (item), "pulseaudio-owner"),
+                                        g_object_get_data (G_OBJECT (item), "pulseaudio-option"));
+}
+
+
+
+static void
+pulseaudio_menu_card_port_activate (GtkCheckMenuItem *item,
+                                    PulseaudioMenu   *menu)
+{
+  g_return_if_fail (IS_PULSEAUDIO_MENU (menu));
+
+  if (gtk_check_menu_item_get_active (item))
+    pulseaudio_volume_set_sink_port (menu->volume,
+                                     g_object_get_data (G_OBJECT (item), "pulseaudio-owner"),
+                                     g_object_get_data (G_OBJECT (item), "pulseaudio-option"));
+}
+
+
+
+/* owner is the card of a profile or the sink of a port */
+static void
+pulseaudio_menu_card_option_append (GtkWidget      *submenu,
+                                    gpointer        owner,
+                                    const gchar    *name,
+                                    const gchar    *description,
+                                    gboolean        available,
+                                    gboolean        active,
+                                    GCallback       callback,
+                                    PulseaudioMenu *menu)
+{
+  GtkWidget *mi;
+
+  mi = gtk_check_menu_item_new_with_label (description != NULL ? description : name);
+  gtk_check_menu_item_set_draw_as_radio (GTK_CHECK_MENU_ITEM (mi), TRUE);
+  gtk_check_menu_item_set_active (GTK_CHECK_MENU_ITEM (mi), active);
+  gtk_widget_set_sensitive (mi, available || active);
+  g_object_set_data_full (G_OBJECT (mi), "pulseaudio-owner", g_object_ref (owner), g_object_unref);
+  g_object_set_data_full (G_OBJECT (mi), "pulseaudio-option", g_strdup (name), g_free);
+  g_signal_connect (G_OBJECT (mi), "activate", callback, menu);
+  gtk_menu_shell_append (GTK_MENU_SHELL (submenu), mi);
+}
+
+
+
+/* Switching happens in place, no mixer process is started */
+static void
+pulseaudio_menu_cards_menu_show (GtkWidget      *cards_menu,
+                                 PulseaudioMenu *menu)
+{
+  GListModel     *cards;
+  GListModel     *sinks;
+  PulseaudioCard *card;
+  PulseaudioSink *sink;
+  GtkWidget      *mi;
+  GtkWidget      *submenu;
+  GList          *children, *li;
+  const gchar    *active_port;
+  guint           n_cards;
+  guint           n_sinks;
+  guint           n_card_sinks;
+  guint           i, j, n;
+
+  g_return_if_fail (IS_PULSEAUDIO_MENU (menu));
+
+  children = gtk_container_get_children (GTK_CONTAINER (cards_menu));
+  for (li = children; li != NULL; li = li->next)
+    gtk_widget_destroy (GTK_WIDGET (li->data));
+  g_list_free (children);
+
+  cards = pulseaudio_volume_get_cards (menu->volume);
+  n_cards = g_list_model_get_n_items (cards);
+  sinks = pulseaudio_volume_get_sinks (menu->volume);
+  n_sinks = g_list_model_get_n_items (sinks);
+  for (i = 0; i < n_cards; i++)
+    {
+      card = g_list_model_get_item (cards, i);
+
+      mi = gtk_menu_item_new_with_label (pulseaudio_card_get_description (card));
+      gtk_menu_shell_append (GTK_MENU_SHELL (cards_menu), mi);
+      submenu = gtk_menu_new ();
+      gtk_menu_item_set_submenu (GTK_MENU_ITEM (mi), submenu);
+
+      for (n = 0; n < pulseaudio_card_get_n_profiles (card); n++)
+        pulseaudio_menu_card_option_append (submenu, card,
+                                            pulseaudio_card_get_profile_name (card, n),
+                                            pulseaudio_card_get_profile_description (card, n),
+                                            pulseaudio_card_get_profile_available (card, n),
+                                            g_strcmp0 (pulseaudio_card_get_profile_name (card, n),
+                                                       pulseaudio_card_get_active_profile (card)) == 0,
+                                            G_CALLBACK (pulseaudio_menu_card_profile_activate), menu);
+
+      /* ports are listed per sink of the active profile, only the
+       * sink that owns a port can switch to it */
+      n_card_sinks = 0;
+      for (j = 0; j < n_sinks; j++)
+        {
+          sink = g_list_model_get_item (sinks, j);
+          if (pulseaudio_sink_get_card (sink) == pulseaudio_card_get_index (card))
+            n_card_sinks++;
+          g_object_unref (G_OBJECT (sink));
+        }
+
+      for (j = 0; j < n_sinks; j++)
+        {
+          sink = g_list_model_get_item (sinks, j);
+          if (pulseaudio_sink_get_card (sink) != pulseaudio_card_get_index (card) ||
+              pulseaudio_sink_get_n_ports (sink) < 2)
+            {
+              g_object_unref (G_OBJECT (sink));
+              continue;
+            }
+
+          mi = gtk_separator_menu_item_new ();
+          gtk_menu_shell_append (GTK_MENU_SHELL (submenu), mi);
+
+          if (n_card_sinks > 1)
+            {
+              mi = gtk_menu_item_new_with_label (pulseaudio_sink_get_description (sink));
+              gtk_widget_set_sensitive (mi, FALSE);
+              gtk_menu_shell_append (GTK_MENU_SHELL (submenu), mi);
+            }
+
+          active_port = pulseaudio_sink_get_active_port (sink);
+          for (n = 0; n < pulseaudio_sink_get_n_ports (sink); n++)
+            pulseaudio_menu_card_option_append (submenu, sink,
+                                                pulseaudio_sink_get_port_name (sink, n),
+                                                pulseaudio_sink_get_port_description (sink, n),
+                                                pulseaudio_sink_get_port_available (sink, n),
+                                                g_strcmp0 (pulseaudio_sink_get_port_name (sink, n),
+                                                           active_port) == 0,
+                                                G_CALLBACK (pulseaudio_menu_card_port_activate), menu);
+
+          g_object_unref (G_OBJECT (sink));
+        }
+
+      g_object_unref (G_OBJECT (card));
+    }
+
+  gtk_widget_show_all (cards_menu);
+}
+
+
+
+static void
+pulseaudio_menu_cards_changed (GListModel     *model,
+                               guint           position,
+                               guint           removed,
+                               guint           added,
+                               PulseaudioMenu *menu)
+{
+  gtk_widget_set_visible (menu->cards_item, g_list_model_get_n_items (model) > 0);
+}
+
+
+
+static void
+pulseaudio_menu_stream_row_update (PulseaudioStream *stream,
+                                   GtkWidget        *row)
+{
+  gchar           *label;
+  const gchar     *name;
+  gboolean         muted;
+  cairo_surface_t *surface;
+  GtkWidget       *image;
+
+  image = gtk_image_menu_item_get_image (GTK_IMAGE_MENU_ITEM (row));
+
+  /* a hash hit for anything seen recently */
+  pulseaudio_icons_lookup_app (image,
+                               pulseaudio_stream_get_name (stream),
+                               pulseaudio_stream_get_icon_name (stream),
+                               pulseaudio_stream_get_binary (stream),
+                               pulseaudio_stream_get_app_id (stream),
+                               MENU_ICON_SIZE, &name, &surface);
+
+  /* most updates are volume changes, the label is left alone then */
+  muted = pulseaudio_stream_get_muted (stream);
+  if (g_strcmp0 (name, g_object_get_data (G_OBJECT (row), "pulseaudio-name")) != 0
+      || muted != GPOINTER_TO_INT (g_object_get_data (G_OBJECT (row), "pulseaudio-muted")))
+    {
+      if (muted)
+        label = g_markup_printf_escaped (_("<b>%s</b> (muted)"), name);
+      else
+        label = g_markup_printf_escaped ("<b>%s</b>", name);
+      scale_menu_item_set_description_label (SCALE_MENU_ITEM (row), label);
+      g_free (label);
+
+      g_object_set_data_full (G_OBJECT (row), "pulseaudio-name", g_strdup (name), g_free);
+      g_object_set_data (G_OBJECT (row), "pulseaudio-muted", GINT_TO_POINTER (muted));
+    }
+
+  /* setting even the same surface queues a resize, skip cache hits;
+   * the reference keeps the pointer from being reused meanwhile */
+  if (surface != NULL && surface != g_object_get_data (G_OBJECT (row), "pulseaudio-surface"))
+    {
+      gtk_image_set_from_surface (GTK_IMAGE (image), surface);
+      g_object_set_data_full (G_OBJECT (row), "pulseaudio-surface",
+                              cairo_surface_reference (surface),
+                              (GDestroyNotify) cairo_surface_destroy);
+    }
+
+  scale_menu_item_set_value (SCALE_MENU_ITEM (row), pulseaudio_stream_get_volume (stream) * 100.0);
+}
+
+
+
+static void
+pulseaudio_menu_stream_row_style_updated (GtkWidget *image,
+                                          GtkWidget *row)
+{
+  PulseaudioStream *stream;
+
+  /* the theme may have changed, pick up the re-rendered icon */
+  stream = g_object_get_data (G_OBJECT (row), "pulseaudio-stream");
+  pulseaudio_menu_stream_row_update (stream, row);
+}
+
+
+
+static void
+pulseaudio_menu_stream_row_value_changed (GtkWidget      *row,
+                                          gdouble         value,
+                                          PulseaudioMenu *menu)
+{
+  g_return_if_fail (IS_PULSEAUDIO_MENU (menu));
+
+  pulseaudio_volume_set_stream_volume (menu->volume,
+                                       g_object_get_data (G_OBJECT (row), "pulseaudio-stream"),
+                                       value / 100.0);
+}
+
+
+
+static gboolean
+pulseaudio_menu_stream_row_button_press (GtkWidget      *row,
+                                         GdkEventButton *event,
+                                         PulseaudioMenu *menu)
+{
+  PulseaudioStream *stream;
+
+  g_return_val_if_fail (IS_PULSEAUDIO_MENU (menu), FALSE);
+
+  /* middle click toggles mute, like on the panel button */
+  if (event->button != 2)
+    return FALSE;
+
+  stream = g_object_get_data (G_OBJECT (row), "pulseaudio-stream");
+  pulseaudio_volume_set_stream_muted (menu->volume, stream, !pulseaudio_stream_get_muted (stream));
+
+  return TRUE;
+}
+
+
+
+static gboolean
+pulseaudio_menu_stream_row_scroll (GtkWidget      *row,
+                                   GdkEventScroll *event,
+                                   PulseaudioMenu *menu)
+{
+  PulseaudioStream *stream;
+
+  g_return_val_if_fail (IS_PULSEAUDIO_MENU (menu), FALSE);
+
+  stream = g_object_get_data (G_OBJECT (row), "pulseaudio-stream");
+
+  /* steps arriving while a write is pending are merged into its target */
+  if (event->direction == GDK_SCROLL_UP)
+    pulseaudio_volume_step_stream_volume (menu->volume, stream, 1);
+  else if (event->direction == GDK_SCROLL_DOWN)
+    pulseaudio_volume_step_stream_volume (menu->volume, stream, -1);
+  else
+    return FALSE;
+
+  return TRUE;
+}
+
+
+
+static GtkWidget *
+pulseaudio_menu_stream_row_new (PulseaudioMenu   *menu,
+                                PulseaudioStream *stream)
+{
+  GtkWidget *row;
+  GtkWidget *image;
+  GtkWidget *bar;
+
+  row = scale_menu_item_new_with_range (0.0, pulseaudio_config_get_volume_max (menu->config), 1.0);
+  image = gtk_image_new ();
+  gtk_image_menu_item_set_image (GTK_IMAGE_MENU_ITEM (row), image);
+
+  g_object_set_data_full (G_OBJECT (row), "pulseaudio-stream", g_object_ref (stream), g_object_unref);
+  pulseaudio_menu_stream_row_update (stream, row);
+
+  /* shown only while the row holds one of the pooled meters */
+  bar = gtk_level_bar_new_for_interval (0.0, 1.0);
+  scale_menu_item_set_meter (SCALE_MENU_ITEM (row), bar);
+  g_object_set_data (G_OBJECT (row), "pulseaudio-level", bar);
+
+  g_signal_connect (G_OBJECT (row), "value-changed",
+                    G_CALLBACK (pulseaudio_menu_stream_row_value_changed), menu);
+  g_signal_connect (G_OBJECT (row), "button-press-event",
+                    G_CALLBACK (pulseaudio_menu_stream_row_button_press), menu);
+  g_signal_connect (G_OBJECT (row), "scroll-event",
+                    G_CALLBACK (pulseaudio_menu_stream_row_scroll), menu);
+  g_signal_connect_object (G_OBJECT (stream), "changed",
+                           G_CALLBACK (pulseaudio_menu_stream_row_update), row, 0);
+  g_signal_connect (G_OBJECT (image), "style-updated",
+                    G_CALLBACK (pulseaudio_menu_stream_row_style_updated), row);
+
+  gtk_widget_show_all (row);
+
+  return row;
+}
+
+
+
+/* streams come and go often (browser tabs), only the affected rows are touched */
+static void
+pulseaudio_menu_streams_changed (GListModel     *model,
+                                 guint           position,
+                                 guint           removed,
+                                 guint           added,
+                                 PulseaudioMenu *menu)
+{
+  PulseaudioStream *stream;
+  GtkWidget        *row;
+  gint              offset;
+  guint             i, j;
+
+  for (i = 0; i < removed; i++)
+    {
+      row = g_ptr_array_index (menu->stream_rows, position);
+      g_ptr_array_remove_index (menu->stream_rows, position);
+
+      for (j = 0; j < STREAM_METERS_MAX; j++)
+        if (menu->stream_meters[j].row == row)
+          pulseaudio_menu_stream_meter_release (&menu->stream_meters[j]);
+
+      gtk_widget_destroy (row);
+    }
+
+  offset = pulseaudio_menu_get_position (menu, menu->streams_header) + 1;
+  for (i = position; i < position + added; i++)
+    {
+      stream = g_list_model_get_item (model, i);
+      row = pulseaudio_menu_stream_row_new (menu, stream);
+      g_object_unref (G_OBJECT (stream));
+
+      g_ptr_array_insert (menu->stream_rows, i, row);
+      gtk_menu_shell_insert (GTK_MENU_SHELL (menu), row, offset + i);
+    }
+
+  gtk_widget_set_visible (menu->streams_header, menu->stream_rows->len > 0);
+  gtk_widget_set_visible (menu->move_item, menu->stream_rows->len > 0);
+
+  /* new streams get a meter on the next frame */
+  menu->stream_meters_checked = 0;
+}
+
+
+
+static void
+pulseaudio_menu_recording_row_update (PulseaudioStream *stream,
+                                      GtkWidget        *row)
+{
+  const gchar     *name;
+  cairo_surface_t *surface;
+  GtkWidget       *image;
+
+  image = gtk_image_menu_item_get_image (GTK_IMAGE_MENU_ITEM (row));
+  pulseaudio_icons_lookup_app (image,
+                               pulseaudio_stream_get_name (stream),
+                               pulseaudio_stream_get_icon_name (stream),
+                               pulseaudio_stream_get_binary (stream),
+                               pulseaudio_stream_get_app_id (stream),
+                               MENU_ICON_SIZE, &name, &surface);
+
+  gtk_menu_item_set_label (GTK_MENU_ITEM (row), name);
+  if (surface != NULL)
+    gtk_image_set_from_surface (GTK_IMAGE (image), surface);
+}
+
+
+
+static void
+pulseaudio_menu_recording_row_style_updated (GtkWidget *image,
+                                             GtkWidget *row)
+{
+  pulseaudio_menu_recording_row_update (g_object_get_data (G_OBJECT (row), "pulseaudio-stream"), row);
+}
+
+
+
+static GtkWidget *
+pulseaudio_menu_recording_row_new (PulseaudioStream *stream)
+{
+  GtkWidget *row;
+  GtkWidget *image;
+
+  row = gtk_image_menu_item_new_with_label ("");
+  image = gtk_image_new ();
+  gtk_image_menu_item_set_image (GTK_IMAGE_MENU_ITEM (row), image);
+  gtk_image_menu_item_set_always_show_image (GTK_IMAGE_MENU_ITEM (row), TRUE);
+
+  g_object_set_data_full (G_OBJECT (row), "pulseaudio-stream", g_object_ref (stream), g_object_unref);
+  pulseaudio_menu_recording_row_update (stream, row);
+
+  g_signal_connect_object (G_OBJECT (stream), "changed",
+                           G_CALLBACK (pulseaudio_menu_recording_row_update), row, 0);
+  g_signal_connect (G_OBJECT (image), "style-updated",
+                    G_CALLBACK (pulseaudio_menu_recording_row_style_updated), row);
+
+  gtk_widget_show_all (row);
+
+  return row;
+}
+
+
+
+static void
+pulseaudio_menu_recording_changed (GListModel     *model,
+                                   guint           position,
+                                   guint           removed,
+                                   guint           added,
+                                   PulseaudioMenu *menu)
+{
+  PulseaudioStream *stream;
+  GtkWidget        *row;
+  gint              offset;
+  guint             i;
+
+  for (i = 0; i < removed; i++)
+    {
+      row = g_ptr_array_index (menu->recording_rows, position);
+      g_ptr_array_remove_index (menu->recording_rows, position);
+      gtk_widget_destroy (row);
+    }
+
+  offset = pulseaudio_menu_get_position (menu, menu->recording_header) + 1;
+  for (i = position; i < position + added; i++)
+    {
+      stream = g_list_model_get_item (model, i);
+      row = pulseaudio_menu_recording_row_new (stream);
+      g_object_unref (G_OBJECT (stream));
+
+      g_ptr_array_insert (menu->recording_rows, i, row);
+      gtk_menu_shell_insert (GTK_MENU_SHELL (menu), row, offset + i);
+    }
+
+  gtk_widget_set_visible (menu->recording_header, menu->recording_rows->len > 0);
+}
+
+
+
+static void
+pulseaudio_menu_move_all_activate (GtkMenuItem    *item,
+                                   PulseaudioMenu *menu)
+{
+  g_return_if_fail (IS_PULSEAUDIO_MENU (menu));
+
+  /* the default follows, so that new streams end up there too */
+  pulseaudio_volume_move_all_streams (menu->volume,
+                                      g_object_get_data (G_OBJECT (item), "pulseaudio-sink"),
+                                      TRUE);
+}
+
+
+
+static void
+pulseaudio_menu_move_stream_activate (GtkMenuItem    *item,
+                                      PulseaudioMenu *menu)
+{
+  g_return_if_fail (IS_PULSEAUDIO_MENU (menu));
+
+  pulseaudio_volume_move_stream (menu->volume,
+                                 g_object_get_data (G_OBJECT (item), "pulseaudio-stream"),
+                                 g_object_get_data (G_OBJECT (item), "pulseaudio-sink"));
+}
+
+
+
+/* The submenu is only rebuilt when opened, not on every stream event */
+static void
+pulseaudio_menu_move_menu_show (GtkWidget      *move_menu,
+                                PulseaudioMenu *menu)
+{
+  GListModel       *sinks;
+  PulseaudioSink   *sink;
+  PulseaudioStream *stream;
+  GtkWidget        *mi;
+  GtkWidget        *submenu;
+  GList            *children, *li;
+  const gchar      *name;
+  gchar            *label;
+  guint             n_sinks;
+  guint             i, j;
+
+  g_return_if_fail (IS_PULSEAUDIO_MENU (menu));
+
+  children = gtk_container_get_children (GTK_CONTAINER (move_menu));
+  for (li = children; li != NULL; li = li->next)
+    gtk_widget_destroy (GTK_WIDGET (li->data));
+  g_list_free (children);
+
+  sinks = pulseaudio_volume_get_sinks (menu->volume);
+  n_sinks = g_list_model_get_n_items (sinks);
+
+  /* move everything */
+  for (i = 0; i < n_sinks; i++)
+    {
+      sink = g_list_model_get_item (sinks, i);
+      label = g_strdup_printf (_("All to %s"), pulseaudio_sink_get_description (sink));
+      mi = gtk_menu_item_new_with_label (label);
+      g_free (label);
+      g_object_set_data_full (G_OBJECT (mi), "pulseaudio-sink", sink, g_object_unref);
+      g_signal_connect (G_OBJECT (mi), "activate",
+                        G_CALLBACK (pulseaudio_menu_move_all_activate), menu);
+      gtk_menu_shell_append (GTK_MENU_SHELL (move_menu), mi);
+    }
+
+  mi = gtk_separator_menu_item_new ();
+  gtk_menu_shell_append (GTK_MENU_SHELL (move_menu), mi);
+
+  /* one submenu per stream */
+  for (i = 0; i < menu->stream_rows->len; i++)
+    {
+      stream = g_object_get_data (G_OBJECT (g_ptr_array_index (menu->stream_rows, i)), "pulseaudio-stream");
+      pulseaudio_icons_lookup_app (GTK_WIDGET (menu),
+                                   pulseaudio_stream_get_name (stream),
+                                   pulseaudio_stream_get_icon_name (stream),
+                                   pulseaudio_stream_get_binary (stream),
+                                   pulseaudio_stream_get_app_id (stream),
+                                   MENU_ICON_SIZE, &name, NULL);
+      mi = gtk_menu_item_new_with_label (name);
+      gtk_menu_shell_append (GTK_MENU_SHELL (move_menu), mi);
+
+      submenu = gtk_menu_new ();
+      gtk_menu_item_set_submenu (GTK_MENU_ITEM (mi), submenu);
+      for (j = 0; j < n_sinks; j++)
+        {
+          sink = g_list_model_get_item (sinks, j);
+          mi = gtk_check_menu_item_new_with_label (pulseaudio_sink_get_description (sink));
+          gtk_check_menu_item_set_draw_as_radio (GTK_CHECK_MENU_ITEM (mi), TRUE);
+          gtk_check_menu_item_set_active (GTK_CHECK_MENU_ITEM (mi),
+                                          pulseaudio_stream_get_device (stream) == pulseaudio_sink_get_index (sink));
+          g_object_set_data_full (G_OBJECT (mi), "pulseaudio-sink", sink, g_object_unref);
+          g_object_set_data_full (G_OBJECT (mi), "pulseaudio-stream", g_object_ref (stream), g_object_unref);
+          g_signal_connect (G_OBJECT (mi), "activate",
+                            G_CALLBACK (pulseaudio_menu_move_stream_activate), menu);
+          gtk_menu_shell_append (GTK_MENU_SHELL (submenu), mi);
+        }
+    }
+
+  gtk_widget_show_all (move_menu);
 }
 
 
@@ -209,7 +1514,11 @@ pulseaudio_menu_new (PulseaudioVolume *volume,
   PulseaudioMenu *menu;
   GdkScreen      *gscreen;
   GtkWidget      *mi;
-  GtkWidget      *img = NULL;
+  GtkWidget      *box;
+  GListModel     *sinks;
+  GListModel     *streams;
+  GListModel     *recording;
+  GListModel     *cards;
   gdouble         volume_max;
 
   g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), NULL);
@@ -236,15 +1545,31 @@ pulseaudio_menu_new (PulseaudioVolume *volume,
   volume_max = pulseaudio_config_get_volume_max (menu->config);
   mi = scale_menu_item_new_with_range (0.0, volume_max, 1.0);
 
-  img = gtk_image_new_from_icon_name ("audio-volume-high-symbolic", GTK_ICON_SIZE_DND);
-  gtk_image_menu_item_set_image (GTK_IMAGE_MENU_ITEM (mi), img);
-  gtk_image_set_pixel_size (GTK_IMAGE (img), 24);
+  menu->image_output = gtk_image_new ();
+  gtk_image_menu_item_set_image (GTK_IMAGE_MENU_ITEM (mi), menu->image_output);
+  g_signal_connect_swapped (G_OBJECT (menu->image_output), "style-updated",
+                            G_CALLBACK (pulseaudio_menu_image_style_updated), menu);
 
   scale_menu_item_set_description_label (SCALE_MENU_ITEM (mi), _("<b>Audio output volume</b>"));
 
   /* range slider */
+  menu->output_item = mi;
   menu->range_output = scale_menu_item_get_scale (SCALE_MENU_ITEM (mi));
 
+  /* peak meter and optional spectrum under the slider, shown while a meter stream runs */
+  menu->meter_box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 2);
+  menu->meter_bar = gtk_level_bar_new_for_interval (0.0, 1.0);
+  gtk_box_pack_start (GTK_BOX (menu->meter_box), menu->meter_bar, FALSE, FALSE, 0);
+  gtk_widget_show (menu->meter_bar);
+  menu->spectrum = pulseaudio_spectrum_new (menu->volume);
+  gtk_widget_set_no_show_all (menu->spectrum, TRUE);
+  gtk_box_pack_start (GTK_BOX (menu->meter_box), menu->spectrum, FALSE, FALSE, 0);
+  pulseaudio_menu_show_spectrum_changed (menu);
+  g_signal_connect_object (G_OBJECT (menu->config), "notify::show-spectrum",
+                           G_CALLBACK (pulseaudio_menu_show_spectrum_changed), menu,
+                           G_CONNECT_SWAPPED);
+  scale_menu_item_set_meter (SCALE_MENU_ITEM (mi), menu->meter_box);
+
   /* update the slider to the current brightness level */
   //gtk_range_set_value (GTK_RANGE (menu->range_output), current_level);
 
@@ -264,6 +1589,84 @@ pulseaudio_menu_new (PulseaudioVolume *volume,
   gtk_widget_show (mi);
   gtk_menu_shell_append (GTK_MENU_SHELL (menu), mi);
 
+  /* output devices, rows follow the sink registry */
+  menu->sinks_header = gtk_menu_item_new_with_label ("");
+  gtk_label_set_markup (GTK_LABEL (gtk_bin_get_child (GTK_BIN (menu->sinks_header))), _("<b>Output devices</b>"));
+  gtk_widget_set_sensitive (menu->sinks_header, FALSE);
+  gtk_widget_show (menu->sinks_header);
+  gtk_menu_shell_append (GTK_MENU_SHELL (menu), menu->sinks_header);
+
+  sinks = pulseaudio_volume_get_sinks (menu->volume);
+  pulseaudio_menu_sinks_changed (sinks, 0, 0, g_list_model_get_n_items (sinks), menu);
+  g_signal_connect_object (G_OBJECT (sinks), "items-changed",
+                           G_CALLBACK (pulseaudio_menu_sinks_changed), menu, 0);
+
+  /* latency of the default sink, shown once the first sample arrives */
+  menu->latency_item = gtk_menu_item_new ();
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 2);
+  menu->latency_label = gtk_label_new (NULL);
+  gtk_widget_set_halign (menu->latency_label, GTK_ALIGN_START);
+  gtk_box_pack_start (GTK_BOX (box), menu->latency_label, FALSE, FALSE, 0);
+  menu->latency_graph = gtk_drawing_area_new ();
+  gtk_widget_set_size_request (menu->latency_graph, -1, 24);
+  g_signal_connect (G_OBJECT (menu->latency_graph), "draw",
+                    G_CALLBACK (pulseaudio_menu_latency_draw), menu);
+  gtk_box_pack_start (GTK_BOX (box), menu->latency_graph, FALSE, FALSE, 0);
+  gtk_container_add (GTK_CONTAINER (menu->latency_item), box);
+  gtk_widget_show_all (box);
+  gtk_widget_set_sensitive (menu->latency_item, FALSE);
+  gtk_widget_set_no_show_all (menu->latency_item, TRUE);
+  gtk_menu_shell_append (GTK_MENU_SHELL (menu), menu->latency_item);
+  g_signal_connect_object (G_OBJECT (menu->volume), "latency-sampled",
+                           G_CALLBACK (pulseaudio_menu_latency_sampled), menu, G_CONNECT_SWAPPED);
+
+  /* card profiles and ports */
+  menu->cards_item = gtk_menu_item_new_with_mnemonic (_("_Profiles and ports"));
+  menu->cards_menu = gtk_menu_new ();
+  gtk_menu_item_set_submenu (GTK_MENU_ITEM (menu->cards_item), menu->cards_menu);
+  g_signal_connect (G_OBJECT (menu->cards_menu), "show",
+                    G_CALLBACK (pulseaudio_menu_cards_menu_show), menu);
+  gtk_menu_shell_append (GTK_MENU_SHELL (menu), menu->cards_item);
+
+  cards = pulseaudio_volume_get_cards (menu->volume);
+  pulseaudio_menu_cards_changed (cards, 0, 0, 0, menu);
+  g_signal_connect_object (G_OBJECT (cards), "items-changed",
+                           G_CALLBACK (pulseaudio_menu_cards_changed), menu, 0);
+
+  /* playback streams, the header is hidden while there are none */
+  menu->streams_header = gtk_menu_item_new_with_label ("");
+  gtk_label_set_markup (GTK_LABEL (gtk_bin_get_child (GTK_BIN (menu->streams_header))), _("<b>Applications</b>"));
+  gtk_widget_set_sensitive (menu->streams_header, FALSE);
+  gtk_menu_shell_append (GTK_MENU_SHELL (menu), menu->streams_header);
+
+  menu->move_item = gtk_menu_item_new_with_mnemonic (_("Move _streams"));
+  menu->move_menu = gtk_menu_new ();
+  gtk_menu_item_set_submenu (GTK_MENU_ITEM (menu->move_item), menu->move_menu);
+  g_signal_connect (G_OBJECT (menu->move_menu), "show",
+                    G_CALLBACK (pulseaudio_menu_move_menu_show), menu);
+  gtk_menu_shell_append (GTK_MENU_SHELL (menu), menu->move_item);
+
+  streams = pulseaudio_volume_get_sink_inputs (menu->volume);
+  pulseaudio_menu_streams_changed (streams, 0, 0, g_list_model_get_n_items (streams), menu);
+  g_signal_connect_object (G_OBJECT (streams), "items-changed",
+                           G_CALLBACK (pulseaudio_menu_streams_changed), menu, 0);
+
+  /* applications recording, hidden while there are none */
+  menu->recording_header = gtk_menu_item_new_with_label ("");
+  gtk_label_set_markup (GTK_LABEL (gtk_bin_get_child (GTK_BIN (menu->recording_header))), _("<b>Recording</b>"));
+  gtk_widget_set_sensitive (menu->recording_header, FALSE);
+  gtk_menu_shell_append (GTK_MENU_SHELL (menu), menu->recording_header);
+
+  recording = pulseaudio_volume_get_source_outputs (menu->volume);
+  pulseaudio_menu_recording_changed (recording, 0, 0, g_list_model_get_n_items (recording), menu);
+  g_signal_connect_object (G_OBJECT (recording), "items-changed",
+                           G_CALLBACK (pulseaudio_menu_recording_changed), menu, 0);
+
+  /* separator */
+  mi = gtk_separator_menu_item_new ();
+  gtk_widget_show (mi);
+  gtk_menu_shell_append (GTK_MENU_SHELL (menu), mi);
+
   /* Audio mixers */
   mi = gtk_menu_item_new_with_mnemonic (_("_Audio mixer..."));
   gtk_widget_show (mi);
@@ -0,0 +1,338 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+
+/*
+ *  This file implements a peak meter on a PulseAudio source. The
+ *  server does the peak detection (PA_STREAM_PEAK_DETECT) and sends
+ *  a single float per period, so the client only compares numbers.
+ *  Without peak detection the meter captures the signal itself and
+ *  keeps the latest samples in a fixed ring for analysis. A meter can
+ *  also follow a single sink input instead of a whole source.
+ *  The stream lives exactly as long as the meter object.
+ *
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_MATH_H
+#include <math.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <glib-object.h>
+#include <pulse/pulseaudio.h>
+
+#include "pulseaudio-debug.h"
+#include "pulseaudio-kernels.h"
+#include "pulseaudio-meter.h"
+
+
+/* Samples kept by a capturing meter, enough for one analysis frame */
+#define METER_RING_SIZE 2048
+
+/* Capturing meters are read about this often per second */
+#define METER_CAPTURE_FRAGMENTS 50
+
+
+static void                 pulseaudio_meter_finalize         (GObject            *object);
+
+
+struct _PulseaudioMeter
+{
+  GObject               __parent__;
+
+  pa_stream            *stream;
+
+  /* highest peak since it was last taken */
+  gfloat                peak;
+  gboolean              peak_valid;
+
+  /* latest samples of a capturing meter, allocated once */
+  gfloat               *ring;
+  guint                 ring_pos;
+  gboolean              ring_fresh;
+
+  /* time spent in the read callback, for the debug log */
+  gint64                created;
+  gint64                busy;
+  guint                 n_reads;
+};
+
+struct _PulseaudioMeterClass
+{
+  GObjectClass          __parent__;
+};
+
+
+
+
+G_DEFINE_TYPE (PulseaudioMeter, pulseaudio_meter, G_TYPE_OBJECT)
+
+static void
+pulseaudio_meter_class_init (PulseaudioMeterClass *klass)
+{
+  GObjectClass      *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->finalize = pulseaudio_meter_finalize;
+}
+
+
+
+static void
+pulseaudio_meter_init (PulseaudioMeter *meter)
+{
+  meter->stream = NULL;
+  meter->peak = 0.0f;
+  meter->peak_valid = FALSE;
+  meter->ring = NULL;
+  meter->ring_pos = 0;
+  meter->ring_fresh = FALSE;
+  meter->created = g_get_monotonic_time ();
+  meter->busy = 0;
+  meter->n_reads = 0;
+}
+
+
+
+static void
+pulseaudio_meter_finalize (GObject *object)
+{
+  PulseaudioMeter *meter = PULSEAUDIO_METER (object);
+  gint64           elapsed;
+
+  if (meter->stream != NULL)
+    {
+      pa_stream_set_read_callback (meter->stream, NULL, NULL);
+      pa_stream_disconnect (meter->stream);
+      pa_stream_unref (meter->stream);
+    }
+
+  g_free (meter->ring);
+
+  elapsed = g_get_monotonic_time () - meter->created;
+  if (elapsed > 0)
+    pulseaudio_debug ("Peak meter: %u reads in %.1f s, %.4f%% of a core in callbacks",
+                      meter->n_reads, elapsed / 1e6, 100.0 * meter->busy / elapsed);
+
+  (*G_OBJECT_CLASS (pulseaudio_meter_parent_class)->finalize) (object);
+}
+
+
+
+/* pa_stream_request_cb_t */
+static void
+pulseaudio_meter_read_cb (pa_stream *stream,
+                          size_t     nbytes,
+                          void      *userdata)
+{
+  PulseaudioMeter *meter = PULSEAUDIO_METER (userdata);
+  const void      *data;
+  const gfloat    *samples;
+  size_t           length;
+  size_t           n_samples;
+  size_t           n;
+  gfloat           peak;
+  gfloat           sumsq;
+  gint64           start;
+
+  start = g_get_monotonic_time ();
+
+  while (pa_stream_readable_size (stream) > 0)
+    {
+      if (pa_stream_peek (stream, &data, &length) < 0)
+        break;
+
+      /* a hole in the buffer, nothing to read */
+      if (data == NULL)
+        {
+          if (length > 0)
+            pa_stream_drop (stream);
+          else
+            break;
+          continue;
+        }
+
+      samples = data;
+      n_samples = length / sizeof (gfloat);
+      pulseaudio_kernels_reduce (samples, n_samples, 1, &peak, &sumsq);
+      meter->peak = MAX (meter->peak, peak);
+      meter->peak_valid = TRUE;
+
+      if (meter->ring != NULL)
+        {
+          for (n = 0; n < n_samples; n++)
+            {
+              meter->ring[meter->ring_pos] = samples[n];
+              meter->ring_pos = (meter->ring_pos + 1) % METER_RING_SIZE;
+            }
+          meter->ring_fresh = TRUE;
+        }
+
+      pa_stream_drop (stream);
+    }
+
+  meter->n_reads++;
+  meter->busy += g_get_monotonic_time () - start;
+}
+
+
+
+/* Returns FALSE if no data arrived since the previous call */
+gboolean
+pulseaudio_meter_take_peak (PulseaudioMeter *meter,
+                            gdouble         *peak)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_METER (meter), FALSE);
+
+  if (!meter->peak_valid)
+    return FALSE;
+
+  if (peak != NULL)
+    *peak = MIN (meter->peak, 1.0f);
+
+  meter->peak = 0.0f;
+  meter->peak_valid = FALSE;
+
+  return TRUE;
+}
+
+
+
+/* Copies the latest n samples of a capturing meter into samples, oldest
+ * first. Returns FALSE if nothing arrived since the previous call. */
+gboolean
+pulseaudio_meter_get_samples (PulseaudioMeter *meter,
+                              gfloat          *samples,
+                              guint            n)
+{
+  guint pos;
+  guint head;
+
+  g_return_val_if_fail (IS_PULSEAUDIO_METER (meter), FALSE);
+  g_return_val_if_fail (meter->ring != NULL, FALSE);
+  g_return_val_if_fail (n <= METER_RING_SIZE, FALSE);
+
+  if (!meter->ring_fresh)
+    return FALSE;
+
+  /* two copies around the wrap point */
+  pos = (meter->ring_pos + METER_RING_SIZE - n) % METER_RING_SIZE;
+  head = MIN (n, METER_RING_SIZE - pos);
+  memcpy (samples, meter->ring + pos, head * sizeof (gfloat));
+  memcpy (samples + head, meter->ring, (n - head) * sizeof (gfloat));
+
+  meter->ring_fresh = FALSE;
+
+  return TRUE;
+}
+
+
+
+static PulseaudioMeter *
+pulseaudio_meter_connect (pa_context  *context,
+                          const gchar *source,
+                          guint32      sink_input,
+                          guint        rate,
+                          gboolean     capture)
+{
+  PulseaudioMeter   *meter;
+  pa_sample_spec     ss;
+  pa_buffer_attr     attr;
+  pa_stream_flags_t  flags;
+
+  meter = g_object_new (TYPE_PULSEAUDIO_METER, NULL);
+
+  /* the peak resampler reduces the source to one value per period */
+  ss.format = PA_SAMPLE_FLOAT32NE;
+  ss.rate = rate;
+  ss.channels = 1;
+
+  memset (&attr, 0xff, sizeof (attr));
+  flags = PA_STREAM_DONT_MOVE | PA_STREAM_ADJUST_LATENCY | PA_STREAM_DONT_INHIBIT_AUTO_SUSPEND;
+
+  if (capture)
+    {
+      meter->ring = g_new0 (gfloat, METER_RING_SIZE);
+      attr.fragsize = (rate / METER_CAPTURE_FRAGMENTS) * sizeof (gfloat);
+    }
+  else
+    {
+      attr.fragsize = sizeof (gfloat);
+      flags |= PA_STREAM_PEAK_DETECT;
+    }
+
+  meter->stream = pa_stream_new (context, "Peak meter", &ss, NULL);
+  if (meter->stream == NULL)
+    {
+      g_warning ("pa_stream_new() failed: %s", pa_strerror (pa_context_errno (context)));
+      return meter;
+    }
+
+  /* without a source the server records from the monitor of the input's sink */
+  if (sink_input != PA_INVALID_INDEX)
+    pa_stream_set_monitor_stream (meter->stream, sink_input);
+
+  pa_stream_set_read_callback (meter->stream, pulseaudio_meter_read_cb, meter);
+
+  if (pa_stream_connect_record (meter->stream, source, &attr, flags) < 0)
+    g_warning ("pa_stream_connect_record() failed: %s", pa_strerror (pa_context_errno (context)));
+
+  return meter;
+}
+
+
+
+PulseaudioMeter *
+pulseaudio_meter_new (pa_context  *context,
+                      const gchar *source,
+                      guint        rate,
+                      gboolean     capture)
+{
+  g_return_val_if_fail (context != NULL, NULL);
+  g_return_val_if_fail (source != NULL, NULL);
+  g_return_val_if_fail (rate > 0, NULL);
+
+  pulseaudio_debug ("%s on %s at %u Hz", capture ? "Capture" : "Peak meter", source, rate);
+
+  return pulseaudio_meter_connect (context, source, PA_INVALID_INDEX, rate, capture);
+}
+
+
+
+PulseaudioMeter *
+pulseaudio_meter_new_for_sink_input (pa_context *context,
+                                     guint32     sink_input,
+                                     guint       rate)
+{
+  g_return_val_if_fail (context != NULL, NULL);
+  g_return_val_if_fail (sink_input != PA_INVALID_INDEX, NULL);
+  g_return_val_if_fail (rate > 0, NULL);
+
+  pulseaudio_debug ("Peak meter on sink input %u at %u Hz", sink_input, rate);
+
+  return pulseaudio_meter_connect (context, NULL, sink_input, rate, FALSE);
+}
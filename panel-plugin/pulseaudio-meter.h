@@ -0,0 +1,54 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __PULSEAUDIO_METER_H__
+#define __PULSEAUDIO_METER_H__
+
+#include <glib-object.h>
+#include <pulse/pulseaudio.h>
+
+G_BEGIN_DECLS
+
+#define TYPE_PULSEAUDIO_METER             (pulseaudio_meter_get_type ())
+#define PULSEAUDIO_METER(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), TYPE_PULSEAUDIO_METER, PulseaudioMeter))
+#define PULSEAUDIO_METER_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass),  TYPE_PULSEAUDIO_METER, PulseaudioMeterClass))
+#define IS_PULSEAUDIO_METER(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), TYPE_PULSEAUDIO_METER))
+#define IS_PULSEAUDIO_METER_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass),  TYPE_PULSEAUDIO_METER))
+#define PULSEAUDIO_METER_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj),  TYPE_PULSEAUDIO_METER, PulseaudioMeterClass))
+
+typedef struct          _PulseaudioMeter                 PulseaudioMeter;
+typedef struct          _PulseaudioMeterClass            PulseaudioMeterClass;
+
+GType                   pulseaudio_meter_get_type        (void) G_GNUC_CONST;
+
+PulseaudioMeter        *pulseaudio_meter_new             (pa_context      *context,
+                                                          const gchar     *source,
+                                                          guint            rate,
+                                                          gboolean         capture);
+PulseaudioMeter        *pulseaudio_meter_new_for_sink_input (pa_context      *context,
+                                                          guint32          sink_input,
+                                                          guint            rate);
+
+gboolean                pulseaudio_meter_take_peak       (PulseaudioMeter *meter,
+                                                          gdouble         *peak);
+gboolean                pulseaudio_meter_get_samples     (PulseaudioMeter *meter,
+                                                          gfloat          *samples,
+                                                          guint            n);
+
+G_END_DECLS
+
+#endif /* !__PULSEAUDIO_METER_H__ */
@@ -19,7 +19,14 @@
 
 
 /*
- *  This file implements a wrapper for libnotify
+ *  This file implements volume notifications
+ *
+ *  Notifications are sent to org.freedesktop.Notifications with
+ *  asynchronous D-Bus calls from the main thread. libnotify is not
+ *  used because notify_notification_show() is a synchronous call that
+ *  blocks for as long as the daemon takes to answer. At most one call
+ *  is in flight; states posted meanwhile replace each other and only
+ *  the latest is sent when the reply arrives.
  *
  */
 
@@ -33,33 +40,26 @@
 #include <math.h>
 #endif
 
-#ifdef HAVE_LIBNOTIFY
-#include <libnotify/notify.h>
+#include <gio/gio.h>
 #include <libxfce4util/libxfce4util.h>
 
 
+#define NOTIFY_NAME      "org.freedesktop.Notifications"
+#define NOTIFY_PATH      "/org/freedesktop/Notifications"
+#define NOTIFY_INTERFACE "org.freedesktop.Notifications"
+#define NOTIFY_APP_NAME  "Xfce volume control"
+#define NOTIFY_TIMEOUT   1500
+
 #define SYNCHRONOUS      "x-canonical-private-synchronous"
 #define LAYOUT_ICON_ONLY "x-canonical-private-icon-only"
 
+#include "pulseaudio-debug.h"
+#include "pulseaudio-icons.h"
 #include "pulseaudio-notify.h"
 
-#define V_MUTED  0
-#define V_LOW    1
-#define V_MEDIUM 2
-#define V_HIGH   3
-
-
-/* Icons for different volume levels */
-static const char *icons[] = {
-  "audio-volume-muted-symbolic",
-  "audio-volume-low-symbolic",
-  "audio-volume-medium-symbolic",
-  "audio-volume-high-symbolic",
-  NULL
-};
-
 
 static void                 pulseaudio_notify_finalize        (GObject            *object);
+static void                 pulseaudio_notify_send            (PulseaudioNotify   *notify);
 
 
 struct _PulseaudioNotify
@@ -69,8 +69,33 @@ struct _PulseaudioNotify
   PulseaudioConfig     *config;
   PulseaudioVolume     *volume;
 
+  /* rate limiting */
+  gdouble               last_volume;
+  gboolean              last_muted;
+  gboolean              last_valid;
+  gint64                last_post;
+  guint                 timeout_id;
+  guint                 n_skipped;
+
+  /* session bus, cancelled on finalize */
+  GCancellable         *cancellable;
+  GDBusConnection      *connection;
   gboolean              gauge_notifications;
-  NotifyNotification   *notification;
+  guint32               replaces_id;
+
+  /* at most one Notify call in flight, the latest state waits */
+  gboolean              in_flight;
+  gint64                sent_time;
+  gboolean              pending;
+  gdouble               pending_volume;
+  gboolean              pending_muted;
+  gint64                pending_time;
+
+  /* statistics, for the debug log */
+  guint                 n_delivered;
+  guint                 n_dropped;
+  gint64                latency_sum;
+  gint64                latency_max;
 };
 
 struct _PulseaudioNotifyClass
@@ -95,31 +120,108 @@ pulseaudio_notify_class_init (PulseaudioNotifyClass *klass)
 
 
 static void
-pulseaudio_notify_init (PulseaudioNotify *notify)
+pulseaudio_notify_caps_cb (GObject      *source,
+                           GAsyncResult *result,
+                           gpointer      user_data)
 {
-  GList *caps_list;
-  GList *node;
+  PulseaudioNotify  *notify;
+  GVariant          *reply;
+  GVariantIter      *iter;
+  const gchar       *cap;
+  gboolean           icon_only = FALSE;
+  guint              n_caps = 0;
+  GError            *error = NULL;
+
+  reply = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &error);
+  if (reply == NULL)
+    {
+      /* the object is gone when the call was cancelled */
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_warning ("Failed to query the notification server: %s", error->message);
+      g_error_free (error);
+      return;
+    }
+
+  notify = PULSEAUDIO_NOTIFY (user_data);
+
+  g_variant_get (reply, "(as)", &iter);
+  while (g_variant_iter_next (iter, "&s", &cap))
+    {
+      if (g_strcmp0 (cap, LAYOUT_ICON_ONLY) == 0)
+        icon_only = TRUE;
+      n_caps++;
+    }
+  g_variant_iter_free (iter);
+  g_variant_unref (reply);
+
+  /* a server that lists nothing keeps the gauge hints */
+  if (n_caps > 0 && !icon_only)
+    notify->gauge_notifications = FALSE;
+}
 
-  notify->gauge_notifications = TRUE;
-  notify->notification = NULL;
 
-  //g_set_application_name ("Xfce volume control");
-  notify_init ("Xfce volume control");
 
-  caps_list = notify_get_server_caps ();
+static void
+pulseaudio_notify_bus_cb (GObject      *source,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  PulseaudioNotify *notify;
+  GDBusConnection  *connection;
+  GError           *error = NULL;
 
-  if (caps_list)
+  connection = g_bus_get_finish (result, &error);
+  if (connection == NULL)
     {
-      node = g_list_find_custom (caps_list, LAYOUT_ICON_ONLY, (GCompareFunc) g_strcmp0);
-      if (!node)
-        notify->gauge_notifications = FALSE;
-      /*		node = g_list_find_custom (caps_list, SYNCHRONOUS, (GCompareFunc) g_strcmp0);*/
-      /*		if (!node)*/
-      /*			Inst->gauge_notifications = FALSE;*/
-      g_list_free (caps_list);
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_warning ("Failed to connect to the session bus: %s", error->message);
+      g_error_free (error);
+      return;
     }
-  notify->notification = notify_notification_new ("xfce4-pulseaudio-plugin", NULL, NULL);
-  notify_notification_set_timeout (notify->notification, 1500);
+
+  notify = PULSEAUDIO_NOTIFY (user_data);
+  notify->connection = connection;
+
+  g_dbus_connection_call (notify->connection, NOTIFY_NAME, NOTIFY_PATH, NOTIFY_INTERFACE,
+                          "GetCapabilities", NULL, G_VARIANT_TYPE ("(as)"),
+                          G_DBUS_CALL_FLAGS_NONE, -1, notify->cancellable,
+                          pulseaudio_notify_caps_cb, notify);
+
+  /* a state posted before the bus was ready */
+  if (notify->pending)
+    pulseaudio_notify_send (notify);
+}
+
+
+
+static void
+pulseaudio_notify_init (PulseaudioNotify *notify)
+{
+  notify->last_volume = 0.0;
+  notify->last_muted = FALSE;
+  notify->last_valid = FALSE;
+  notify->last_post = 0;
+  notify->timeout_id = 0;
+  notify->n_skipped = 0;
+
+  notify->cancellable = g_cancellable_new ();
+  notify->connection = NULL;
+  notify->gauge_notifications = TRUE;
+  notify->replaces_id = 0;
+
+  notify->in_flight = FALSE;
+  notify->sent_time = 0;
+  notify->pending = FALSE;
+  notify->pending_volume = 0.0;
+  notify->pending_muted = FALSE;
+  notify->pending_time = 0;
+
+  notify->n_delivered = 0;
+  notify->n_dropped = 0;
+  notify->latency_sum = 0;
+  notify->latency_max = 0;
+
+  g_bus_get (G_BUS_TYPE_SESSION, notify->cancellable, pulseaudio_notify_bus_cb, notify);
 }
 
 
@@ -129,71 +231,192 @@ pulseaudio_notify_finalize (GObject *object)
 {
   PulseaudioNotify *notify = PULSEAUDIO_NOTIFY (object);
 
-  notify->config = NULL;
+  if (notify->timeout_id != 0)
+    g_source_remove (notify->timeout_id);
+
+  /* replies still on their way find the call cancelled and do not
+   * touch the object; nothing here waits for the daemon */
+  g_cancellable_cancel (notify->cancellable);
+  g_object_unref (G_OBJECT (notify->cancellable));
+
+  if (notify->connection != NULL)
+    g_object_unref (G_OBJECT (notify->connection));
+
+  pulseaudio_debug ("Notifications: %u shown, %u superseded, %u unchanged, latency %.1f ms average, %.1f ms max",
+                    notify->n_delivered, notify->n_dropped, notify->n_skipped,
+                    notify->n_delivered > 0 ? notify->latency_sum / 1000.0 / notify->n_delivered : 0.0,
+                    notify->latency_max / 1000.0);
 
-  g_object_unref (G_OBJECT (notify->notification));
-  notify->notification = NULL;
-  notify_uninit ();
+  notify->config = NULL;
 
   (*G_OBJECT_CLASS (pulseaudio_notify_parent_class)->finalize) (object);
 }
 
 
 
-void
-pulseaudio_notify_notify (PulseaudioNotify *notify)
+static void
+pulseaudio_notify_send_cb (GObject      *source,
+                           GAsyncResult *result,
+                           gpointer      user_data)
 {
-  GError      *error = NULL;
-  gdouble      volume;
-  gint         volume_i;
-  gboolean     muted;
-  gchar       *title = NULL;
-  const gchar *icon = NULL;
+  PulseaudioNotify *notify;
+  GVariant         *reply;
+  GError           *error = NULL;
+  gint64            latency;
 
-  g_return_if_fail (IS_PULSEAUDIO_NOTIFY (notify));
-  g_return_if_fail (IS_PULSEAUDIO_VOLUME (notify->volume));
+  reply = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &error);
+  if (reply == NULL && g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      g_error_free (error);
+      return;
+    }
 
-  volume = pulseaudio_volume_get_volume (notify->volume);
-  muted = pulseaudio_volume_get_muted (notify->volume);
-  volume_i = (gint) round (volume * 100);
+  notify = PULSEAUDIO_NOTIFY (user_data);
+  notify->in_flight = FALSE;
+
+  if (reply != NULL)
+    {
+      /* the next notification replaces this one on screen */
+      g_variant_get (reply, "(u)", &notify->replaces_id);
+      g_variant_unref (reply);
+
+      /* from the key press to the daemon accepting the notification */
+      latency = g_get_monotonic_time () - notify->sent_time;
+      notify->n_delivered++;
+      notify->latency_sum += latency;
+      notify->latency_max = MAX (notify->latency_max, latency);
+      pulseaudio_debug ("Notification shown after %.1f ms", latency / 1000.0);
+    }
+  else
+    {
+      g_warning ("Error while sending notification: %s", error->message);
+      g_error_free (error);
+    }
+
+  if (notify->pending)
+    pulseaudio_notify_send (notify);
+}
+
+
+
+/* Sends the pending state unless a call is still in flight */
+static void
+pulseaudio_notify_send (PulseaudioNotify *notify)
+{
+  GVariantBuilder  hints;
+  gint             volume_i;
+  gchar           *title;
+  const gchar     *icon;
+
+  if (notify->connection == NULL || notify->in_flight || !notify->pending)
+    return;
 
-  if (muted)
+  volume_i = (gint) round (notify->pending_volume * 100);
+
+  if (notify->pending_muted)
     title = g_strdup_printf ( _("Volume %d%c (muted)"), volume_i, '%');
   else
     title = g_strdup_printf ( _("Volume %d%c"), volume_i, '%');
 
-  if (muted)
-    icon = icons[V_MUTED];
-  else if (volume <= 0.0)
-    icon = icons[V_MUTED];
-  else if (volume <= 0.3)
-    icon = icons[V_LOW];
-  else if (volume <= 0.7)
-    icon = icons[V_MEDIUM];
-  else
-    icon = icons[V_HIGH];
+  /* The notification daemon renders the icon itself, pass the name */
+  icon = pulseaudio_icons_get_name (pulseaudio_icons_get_level (notify->pending_volume, notify->pending_muted));
 
+  g_variant_builder_init (&hints, G_VARIANT_TYPE ("a{sv}"));
+  if (notify->gauge_notifications)
+    {
+      g_variant_builder_add (&hints, "{sv}", "value", g_variant_new_int32 (volume_i));
+      g_variant_builder_add (&hints, "{sv}", SYNCHRONOUS, g_variant_new_string (""));
+    }
 
-  notify_notification_update (notify->notification,
-                              title,
-                              NULL,
-                              icon);
+  g_dbus_connection_call (notify->connection, NOTIFY_NAME, NOTIFY_PATH, NOTIFY_INTERFACE,
+                          "Notify",
+                          g_variant_new ("(susssasa{sv}i)", NOTIFY_APP_NAME, notify->replaces_id,
+                                         icon, title, "", NULL, &hints, NOTIFY_TIMEOUT),
+                          G_VARIANT_TYPE ("(u)"), G_DBUS_CALL_FLAGS_NONE, -1,
+                          notify->cancellable, pulseaudio_notify_send_cb, notify);
   g_free (title);
 
-  if (notify->gauge_notifications) {
-    notify_notification_set_hint_int32 (notify->notification,
-                                        "value",
-                                        volume_i);
-    notify_notification_set_hint_string (notify->notification,
-                                         "x-canonical-private-synchronous",
-                                         "");
-  }
+  notify->in_flight = TRUE;
+  notify->sent_time = notify->pending_time;
+  notify->pending = FALSE;
+}
+
+
 
-  if (!notify_notification_show (notify->notification, &error))
+/* Queues the current state and sends it if no call is in flight */
+static void
+pulseaudio_notify_post (PulseaudioNotify *notify)
+{
+  gdouble  volume;
+  gboolean muted;
+
+  /* show where a ramp is heading rather than where it is */
+  volume = pulseaudio_volume_get_target_volume (notify->volume);
+  muted = pulseaudio_volume_get_muted (notify->volume);
+
+  /* an unchanged state is dropped only while the last notification
+   * is still on screen, after that it is shown again */
+  if (notify->last_valid && notify->last_volume == volume && notify->last_muted == muted &&
+      g_get_monotonic_time () - notify->last_post < NOTIFY_TIMEOUT * G_GINT64_CONSTANT (1000))
     {
-      g_warning ("Error while sending notification : %s\n", error->message);
-      g_error_free (error);
+      notify->n_skipped++;
+      return;
     }
+
+  notify->last_volume = volume;
+  notify->last_muted = muted;
+  notify->last_valid = TRUE;
+  notify->last_post = g_get_monotonic_time ();
+
+  /* the previous state has not been sent yet */
+  if (notify->pending)
+    notify->n_dropped++;
+
+  notify->pending_volume = volume;
+  notify->pending_muted = muted;
+  notify->pending_time = notify->last_post;
+  notify->pending = TRUE;
+
+  pulseaudio_notify_send (notify);
+}
+
+
+
+static gboolean
+pulseaudio_notify_timeout (gpointer user_data)
+{
+  PulseaudioNotify *notify = PULSEAUDIO_NOTIFY (user_data);
+
+  notify->timeout_id = 0;
+  pulseaudio_notify_post (notify);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+
+/* At most notify-rate updates per second; a burst of calls ends with
+ * one more update so that the final state is always shown */
+void
+pulseaudio_notify_notify (PulseaudioNotify *notify)
+{
+  gint64 interval;
+  gint64 elapsed;
+
+  g_return_if_fail (IS_PULSEAUDIO_NOTIFY (notify));
+  g_return_if_fail (IS_PULSEAUDIO_VOLUME (notify->volume));
+
+  /* the pending update reads the state when it fires */
+  if (notify->timeout_id != 0)
+    return;
+
+  interval = G_USEC_PER_SEC / pulseaudio_config_get_notify_rate (notify->config);
+  elapsed = g_get_monotonic_time () - notify->last_post;
+
+  if (elapsed >= interval)
+    pulseaudio_notify_post (notify);
+  else
+    notify->timeout_id = g_timeout_add ((interval - elapsed + 999) / 1000, pulseaudio_notify_timeout, notify);
 }
 
 
@@ -215,5 +438,3 @@ pulseaudio_notify_new (PulseaudioConfig *config,
   return notify;
 }
 
-
-#endif /* HAVE_LIBNOTIFY */
@@ -19,8 +19,6 @@
 #ifndef __PULSEAUDIO_NOTIFY_H__
 #define __PULSEAUDIO_NOTIFY_H__
 
-#ifdef HAVE_LIBNOTIFY
-
 #include <glib-object.h>
 #include "pulseaudio-config.h"
 #include "pulseaudio-volume.h"
@@ -46,5 +44,4 @@ void                    pulseaudio_notify_notify          (PulseaudioNotify *not
 
 G_END_DECLS
 
-#endif /* HAVE_LIBNOTIFY */
 #endif /* !__PULSEAUDIO_NOTIFY_H__ */
@@ -90,9 +90,7 @@ struct _PulseaudioPlugin
 
   PulseaudioConfig    *config;
   PulseaudioVolume    *volume;
-#ifdef HAVE_LIBNOTIFY
   PulseaudioNotify    *notify;
-#endif
 
   /* panel widgets */
   GtkWidget           *button;
@@ -134,9 +132,7 @@ pulseaudio_plugin_init (PulseaudioPlugin *pulseaudio_plugin)
 
   pulseaudio_plugin->volume            = NULL;
   pulseaudio_plugin->button            = NULL;
-#ifdef HAVE_LIBNOTIFY
   pulseaudio_plugin->notify            = NULL;
-#endif
 }
 
 
@@ -297,15 +293,13 @@ pulseaudio_plugin_volume_key_pressed (const char            *keystring,
                                       void                  *user_data)
 {
   PulseaudioPlugin *pulseaudio_plugin = PULSEAUDIO_PLUGIN (user_data);
-  gdouble           volume            = pulseaudio_volume_get_volume (pulseaudio_plugin->volume);
-  gdouble           volume_step       = pulseaudio_config_get_volume_step (pulseaudio_plugin->config) / 100.0;
 
   pulseaudio_debug ("%s pressed", keystring);
 
   if (strcmp (keystring, PULSEAUDIO_PLUGIN_RAISE_VOLUME_KEY) == 0)
-    pulseaudio_volume_set_volume (pulseaudio_plugin->volume, MIN (volume + volume_step, MAX (volume, 1.0)));
+    pulseaudio_volume_step_volume (pulseaudio_plugin->volume, 1, FALSE);
   else if (strcmp (keystring, PULSEAUDIO_PLUGIN_LOWER_VOLUME_KEY) == 0)
-    pulseaudio_volume_set_volume (pulseaudio_plugin->volume, volume - volume_step);
+    pulseaudio_volume_step_volume (pulseaudio_plugin->volume, -1, FALSE);
   pulseaudio_notify (pulseaudio_plugin);
 }
 
@@ -327,9 +321,7 @@ pulseaudio_plugin_mute_pressed (const char            *keystring,
 void
 pulseaudio_notify (PulseaudioPlugin *pulseaudio_plugin)
 {
-#ifdef HAVE_LIBNOTIFY
   pulseaudio_notify_notify (pulseaudio_plugin->notify);
-#endif
 }
 
 
@@ -372,10 +364,8 @@ pulseaudio_plugin_construct (XfcePanelPlugin *plugin)
   pulseaudio_plugin->volume = pulseaudio_volume_new (pulseaudio_plugin->config);
 
   /* initialize notify wrapper */
-#ifdef HAVE_LIBNOTIFY
   pulseaudio_plugin->notify = pulseaudio_notify_new (pulseaudio_plugin->config,
                                                      pulseaudio_plugin->volume);
-#endif
 
   /* instantiate a button box */
   pulseaudio_plugin->button = pulseaudio_button_new (pulseaudio_plugin,
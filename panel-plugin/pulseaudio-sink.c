@@ -0,0 +1,398 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+
+/*
+ *  This file implements an entry of the sink registry kept by
+ *  PulseaudioVolume. Entries are updated in place and emit "changed"
+ *  only when one of their fields actually changes.
+ *
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib-object.h>
+#include <pulse/pulseaudio.h>
+
+#include "pulseaudio-sink.h"
+
+
+static void                 pulseaudio_sink_finalize          (GObject            *object);
+
+
+typedef struct
+{
+  gchar                *name;
+  gchar                *description;
+  gboolean              available;
+} PulseaudioSinkPort;
+
+
+struct _PulseaudioSink
+{
+  GObject               __parent__;
+
+  guint32               index;
+  gchar                *name;
+  gchar                *description;
+  gdouble               volume;
+  gboolean              muted;
+  gboolean              is_default;
+  guint32               card;
+  gchar                *active_port;
+  GArray               *ports;
+};
+
+struct _PulseaudioSinkClass
+{
+  GObjectClass          __parent__;
+};
+
+
+
+
+enum
+{
+  CHANGED,
+  LAST_SIGNAL
+};
+
+static guint pulseaudio_sink_signals[LAST_SIGNAL] = { 0, };
+
+
+
+
+G_DEFINE_TYPE (PulseaudioSink, pulseaudio_sink, G_TYPE_OBJECT)
+
+static void
+pulseaudio_sink_class_init (PulseaudioSinkClass *klass)
+{
+  GObjectClass      *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->finalize = pulseaudio_sink_finalize;
+
+  pulseaudio_sink_signals[CHANGED] =
+    g_signal_new (g_intern_static_string ("changed"),
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL,
+                  g_cclosure_marshal_VOID__VOID,
+                  G_TYPE_NONE, 0);
+}
+
+
+
+static void
+pulseaudio_sink_port_clear (gpointer data)
+{
+  PulseaudioSinkPort *port = data;
+
+  g_free (port->name);
+  g_free (port->description);
+}
+
+
+
+static void
+pulseaudio_sink_init (PulseaudioSink *sink)
+{
+  sink->index = 0;
+  sink->name = NULL;
+  sink->description = NULL;
+  sink->volume = 0.0;
+  sink->muted = FALSE;
+  sink->is_default = FALSE;
+  sink->card = G_MAXUINT32;
+  sink->active_port = NULL;
+  sink->ports = g_array_new (FALSE, TRUE, sizeof (PulseaudioSinkPort));
+  g_array_set_clear_func (sink->ports, pulseaudio_sink_port_clear);
+}
+
+
+
+static void
+pulseaudio_sink_finalize (GObject *object)
+{
+  PulseaudioSink *sink = PULSEAUDIO_SINK (object);
+
+  g_free (sink->name);
+  g_free (sink->description);
+  g_free (sink->active_port);
+  g_array_free (sink->ports, TRUE);
+
+  (*G_OBJECT_CLASS (pulseaudio_sink_parent_class)->finalize) (object);
+}
+
+
+
+guint32
+pulseaudio_sink_get_index (PulseaudioSink *sink)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_SINK (sink), 0);
+
+  return sink->index;
+}
+
+
+
+const gchar *
+pulseaudio_sink_get_name (PulseaudioSink *sink)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_SINK (sink), NULL);
+
+  return sink->name;
+}
+
+
+
+const gchar *
+pulseaudio_sink_get_description (PulseaudioSink *sink)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_SINK (sink), NULL);
+
+  return (sink->description != NULL) ? sink->description : sink->name;
+}
+
+
+
+gdouble
+pulseaudio_sink_get_volume (PulseaudioSink *sink)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_SINK (sink), 0.0);
+
+  return sink->volume;
+}
+
+
+
+gboolean
+pulseaudio_sink_get_muted (PulseaudioSink *sink)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_SINK (sink), FALSE);
+
+  return sink->muted;
+}
+
+
+
+gboolean
+pulseaudio_sink_get_default (PulseaudioSink *sink)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_SINK (sink), FALSE);
+
+  return sink->is_default;
+}
+
+
+
+guint32
+pulseaudio_sink_get_card (PulseaudioSink *sink)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_SINK (sink), G_MAXUINT32);
+
+  return sink->card;
+}
+
+
+
+const gchar *
+pulseaudio_sink_get_active_port (PulseaudioSink *sink)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_SINK (sink), NULL);
+
+  return sink->active_port;
+}
+
+
+
+/* Ports of the sink itself, i.e. those the active card profile offers */
+guint
+pulseaudio_sink_get_n_ports (PulseaudioSink *sink)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_SINK (sink), 0);
+
+  return sink->ports->len;
+}
+
+
+
+const gchar *
+pulseaudio_sink_get_port_name (PulseaudioSink *sink,
+                               guint           n)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_SINK (sink), NULL);
+  g_return_val_if_fail (n < sink->ports->len, NULL);
+
+  return g_array_index (sink->ports, PulseaudioSinkPort, n).name;
+}
+
+
+
+const gchar *
+pulseaudio_sink_get_port_description (PulseaudioSink *sink,
+                                      guint           n)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_SINK (sink), NULL);
+  g_return_val_if_fail (n < sink->ports->len, NULL);
+
+  return g_array_index (sink->ports, PulseaudioSinkPort, n).description;
+}
+
+
+
+gboolean
+pulseaudio_sink_get_port_available (PulseaudioSink *sink,
+                                    guint           n)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_SINK (sink), FALSE);
+  g_return_val_if_fail (n < sink->ports->len, FALSE);
+
+  return g_array_index (sink->ports, PulseaudioSinkPort, n).available;
+}
+
+
+
+void
+pulseaudio_sink_update (PulseaudioSink *sink,
+                        const gchar    *name,
+                        const gchar    *description,
+                        gdouble         volume,
+                        gboolean        muted,
+                        guint32         card,
+                        const gchar    *active_port)
+{
+  gboolean changed = FALSE;
+
+  g_return_if_fail (IS_PULSEAUDIO_SINK (sink));
+
+  if (g_strcmp0 (sink->name, name) != 0)
+    {
+      g_free (sink->name);
+      sink->name = g_strdup (name);
+      changed = TRUE;
+    }
+
+  if (g_strcmp0 (sink->description, description) != 0)
+    {
+      g_free (sink->description);
+      sink->description = g_strdup (description);
+      changed = TRUE;
+    }
+
+  if (ABS (sink->volume - volume) > 2e-3)
+    {
+      sink->volume = volume;
+      changed = TRUE;
+    }
+
+  if (sink->muted != muted)
+    {
+      sink->muted = muted;
+      changed = TRUE;
+    }
+
+  if (sink->card != card)
+    {
+      sink->card = card;
+      changed = TRUE;
+    }
+
+  if (g_strcmp0 (sink->active_port, active_port) != 0)
+    {
+      g_free (sink->active_port);
+      sink->active_port = g_strdup (active_port);
+      changed = TRUE;
+    }
+
+  if (changed)
+    g_signal_emit (G_OBJECT (sink), pulseaudio_sink_signals [CHANGED], 0);
+}
+
+
+
+void
+pulseaudio_sink_update_ports (PulseaudioSink     *sink,
+                              pa_sink_port_info **ports,
+                              guint32             n_ports)
+{
+  PulseaudioSinkPort *port;
+  gboolean            available;
+  gboolean            changed = FALSE;
+  guint               n;
+
+  g_return_if_fail (IS_PULSEAUDIO_SINK (sink));
+
+  if (sink->ports->len != n_ports)
+    {
+      g_array_set_size (sink->ports, n_ports);
+      changed = TRUE;
+    }
+
+  for (n = 0; n < n_ports; n++)
+    {
+      port = &g_array_index (sink->ports, PulseaudioSinkPort, n);
+      available = ports[n]->available != PA_PORT_AVAILABLE_NO;
+      if (g_strcmp0 (port->name, ports[n]->name) == 0 &&
+          g_strcmp0 (port->description, ports[n]->description) == 0 &&
+          port->available == available)
+        continue;
+
+      g_free (port->name);
+      g_free (port->description);
+      port->name = g_strdup (ports[n]->name);
+      port->description = g_strdup (ports[n]->description);
+      port->available = available;
+      changed = TRUE;
+    }
+
+  if (changed)
+    g_signal_emit (G_OBJECT (sink), pulseaudio_sink_signals [CHANGED], 0);
+}
+
+
+
+void
+pulseaudio_sink_set_default (PulseaudioSink *sink,
+                             gboolean        is_default)
+{
+  g_return_if_fail (IS_PULSEAUDIO_SINK (sink));
+
+  if (sink->is_default != is_default)
+    {
+      sink->is_default = is_default;
+      g_signal_emit (G_OBJECT (sink), pulseaudio_sink_signals [CHANGED], 0);
+    }
+}
+
+
+
+PulseaudioSink *
+pulseaudio_sink_new (guint32 index)
+{
+  PulseaudioSink *sink;
+
+  sink = g_object_new (TYPE_PULSEAUDIO_SINK, NULL);
+  sink->index = index;
+
+  return sink;
+}
@@ -0,0 +1,71 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __PULSEAUDIO_SINK_H__
+#define __PULSEAUDIO_SINK_H__
+
+#include <glib-object.h>
+#include <pulse/pulseaudio.h>
+
+G_BEGIN_DECLS
+
+#define TYPE_PULSEAUDIO_SINK             (pulseaudio_sink_get_type ())
+#define PULSEAUDIO_SINK(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), TYPE_PULSEAUDIO_SINK, PulseaudioSink))
+#define PULSEAUDIO_SINK_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass),  TYPE_PULSEAUDIO_SINK, PulseaudioSinkClass))
+#define IS_PULSEAUDIO_SINK(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), TYPE_PULSEAUDIO_SINK))
+#define IS_PULSEAUDIO_SINK_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass),  TYPE_PULSEAUDIO_SINK))
+#define PULSEAUDIO_SINK_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj),  TYPE_PULSEAUDIO_SINK, PulseaudioSinkClass))
+
+typedef struct          _PulseaudioSink                 PulseaudioSink;
+typedef struct          _PulseaudioSinkClass            PulseaudioSinkClass;
+
+GType                   pulseaudio_sink_get_type        (void) G_GNUC_CONST;
+
+PulseaudioSink         *pulseaudio_sink_new             (guint32         index);
+
+guint32                 pulseaudio_sink_get_index       (PulseaudioSink *sink);
+const gchar            *pulseaudio_sink_get_name        (PulseaudioSink *sink);
+const gchar            *pulseaudio_sink_get_description (PulseaudioSink *sink);
+gdouble                 pulseaudio_sink_get_volume      (PulseaudioSink *sink);
+gboolean                pulseaudio_sink_get_muted       (PulseaudioSink *sink);
+gboolean                pulseaudio_sink_get_default     (PulseaudioSink *sink);
+guint32                 pulseaudio_sink_get_card        (PulseaudioSink *sink);
+const gchar            *pulseaudio_sink_get_active_port (PulseaudioSink *sink);
+guint                   pulseaudio_sink_get_n_ports     (PulseaudioSink *sink);
+const gchar            *pulseaudio_sink_get_port_name   (PulseaudioSink *sink,
+                                                         guint           n);
+const gchar            *pulseaudio_sink_get_port_description (PulseaudioSink *sink,
+                                                         guint           n);
+gboolean                pulseaudio_sink_get_port_available (PulseaudioSink *sink,
+                                                         guint           n);
+
+void                    pulseaudio_sink_update          (PulseaudioSink *sink,
+                                                         const gchar    *name,
+                                                         const gchar    *description,
+                                                         gdouble         volume,
+                                                         gboolean        muted,
+                                                         guint32         card,
+                                                         const gchar    *active_port);
+void                    pulseaudio_sink_update_ports    (PulseaudioSink     *sink,
+                                                         pa_sink_port_info **ports,
+                                                         guint32             n_ports);
+void                    pulseaudio_sink_set_default     (PulseaudioSink *sink,
+                                                         gboolean        is_default);
+
+G_END_DECLS
+
+#endif /* !__PULSEAUDIO_SINK_H__ */
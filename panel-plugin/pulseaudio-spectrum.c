@@ -0,0 +1,279 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+
+/*
+ *  This file implements a spectrum view of the default sink. The
+ *  monitor is captured only while the widget is mapped; each frame the
+ *  latest block is passed to the analyzer and its band levels are drawn
+ *  as bars that jump up and fall back slowly.
+ *
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <gtk/gtk.h>
+
+#include "pulseaudio-analyzer.h"
+#include "pulseaudio-debug.h"
+#include "pulseaudio-spectrum.h"
+
+
+#define SPECTRUM_N_BANDS    PULSEAUDIO_ANALYZER_N_BANDS
+/* how fast bars fall, in full heights per second */
+#define SPECTRUM_FALL_RATE  1.5
+#define SPECTRUM_HEIGHT     48
+
+
+static void                 pulseaudio_spectrum_finalize      (GObject            *object);
+static void                 pulseaudio_spectrum_map           (GtkWidget          *widget);
+static void                 pulseaudio_spectrum_unmap         (GtkWidget          *widget);
+static gboolean             pulseaudio_spectrum_draw          (GtkWidget          *widget,
+                                                               cairo_t            *cr);
+
+
+struct _PulseaudioSpectrum
+{
+  GtkDrawingArea        __parent__;
+
+  PulseaudioVolume     *volume;
+  PulseaudioMeter      *capture;
+  guint                 tick_id;
+  gint64                last_frame_time;
+
+  PulseaudioAnalyzer   *analyzer;
+  gfloat                levels[SPECTRUM_N_BANDS];
+
+  /* displayed band heights, 0..1 */
+  gfloat                bands[SPECTRUM_N_BANDS];
+
+  /* analysis cost, for the debug log */
+  gint64                busy;
+  guint                 n_frames;
+};
+
+struct _PulseaudioSpectrumClass
+{
+  GtkDrawingAreaClass   __parent__;
+};
+
+
+
+
+G_DEFINE_TYPE (PulseaudioSpectrum, pulseaudio_spectrum, GTK_TYPE_DRAWING_AREA)
+
+static void
+pulseaudio_spectrum_class_init (PulseaudioSpectrumClass *klass)
+{
+  GObjectClass      *gobject_class;
+  GtkWidgetClass    *gtkwidget_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->finalize = pulseaudio_spectrum_finalize;
+
+  gtkwidget_class = GTK_WIDGET_CLASS (klass);
+  gtkwidget_class->map = pulseaudio_spectrum_map;
+  gtkwidget_class->unmap = pulseaudio_spectrum_unmap;
+  gtkwidget_class->draw = pulseaudio_spectrum_draw;
+}
+
+
+
+static void
+pulseaudio_spectrum_init (PulseaudioSpectrum *spectrum)
+{
+  guint   i;
+
+  spectrum->volume = NULL;
+  spectrum->capture = NULL;
+  spectrum->tick_id = 0;
+  spectrum->last_frame_time = 0;
+  spectrum->busy = 0;
+  spectrum->n_frames = 0;
+  spectrum->analyzer = pulseaudio_analyzer_new ();
+
+  for (i = 0; i < SPECTRUM_N_BANDS; i++)
+    spectrum->bands[i] = 0.0f;
+
+  gtk_widget_set_size_request (GTK_WIDGET (spectrum), -1, SPECTRUM_HEIGHT);
+}
+
+
+
+static void
+pulseaudio_spectrum_finalize (GObject *object)
+{
+  PulseaudioSpectrum *spectrum = PULSEAUDIO_SPECTRUM (object);
+
+  if (spectrum->capture != NULL)
+    g_object_unref (G_OBJECT (spectrum->capture));
+
+  pulseaudio_analyzer_free (spectrum->analyzer);
+
+  (*G_OBJECT_CLASS (pulseaudio_spectrum_parent_class)->finalize) (object);
+}
+
+
+
+static gboolean
+pulseaudio_spectrum_tick (GtkWidget     *widget,
+                          GdkFrameClock *frame_clock,
+                          gpointer       user_data)
+{
+  PulseaudioSpectrum *spectrum = PULSEAUDIO_SPECTRUM (widget);
+  gint64              frame_time;
+  gint64              start;
+  gdouble             fall;
+  gdouble             level;
+  gboolean            fresh;
+  gboolean            changed = FALSE;
+  guint               i;
+
+  frame_time = gdk_frame_clock_get_frame_time (frame_clock);
+  fall = (spectrum->last_frame_time > 0)
+    ? SPECTRUM_FALL_RATE * (frame_time - spectrum->last_frame_time) / 1e6 : 0.0;
+  spectrum->last_frame_time = frame_time;
+
+  start = g_get_monotonic_time ();
+
+  fresh = spectrum->capture != NULL &&
+    pulseaudio_meter_get_samples (spectrum->capture,
+                                  pulseaudio_analyzer_get_input (spectrum->analyzer),
+                                  PULSEAUDIO_ANALYZER_SIZE);
+  if (fresh)
+    {
+      pulseaudio_analyzer_run (spectrum->analyzer, spectrum->levels);
+      spectrum->busy += g_get_monotonic_time () - start;
+      spectrum->n_frames++;
+    }
+
+  /* bars fall on every frame, also while the monitor delivers nothing
+   * (idle or suspended sink), and jump up to fresh levels; once all of
+   * them rest at 0 nothing changes and no redraw is queued */
+  for (i = 0; i < SPECTRUM_N_BANDS; i++)
+    {
+      level = MAX (spectrum->bands[i] - fall, 0.0);
+      if (fresh)
+        level = MAX (level, spectrum->levels[i]);
+      if (ABS (level - spectrum->bands[i]) > 1e-3 || (level == 0.0 && spectrum->bands[i] != 0.0f))
+        {
+          spectrum->bands[i] = level;
+          changed = TRUE;
+        }
+    }
+
+  if (changed)
+    gtk_widget_queue_draw (widget);
+
+  return G_SOURCE_CONTINUE;
+}
+
+
+
+static gboolean
+pulseaudio_spectrum_draw (GtkWidget *widget,
+                          cairo_t   *cr)
+{
+  PulseaudioSpectrum *spectrum = PULSEAUDIO_SPECTRUM (widget);
+  GtkStyleContext    *context;
+  GdkRGBA             fg;
+  gdouble             width, height, bar;
+  guint               i;
+
+  context = gtk_widget_get_style_context (widget);
+  gtk_style_context_get_color (context, gtk_widget_get_state_flags (widget), &fg);
+  gdk_cairo_set_source_rgba (cr, &fg);
+
+  width = gtk_widget_get_allocated_width (widget);
+  height = gtk_widget_get_allocated_height (widget);
+  bar = width / SPECTRUM_N_BANDS;
+
+  for (i = 0; i < SPECTRUM_N_BANDS; i++)
+    cairo_rectangle (cr, i * bar + 1.0, height * (1.0 - spectrum->bands[i]),
+                     MAX (bar - 2.0, 1.0), height * spectrum->bands[i]);
+  cairo_fill (cr);
+
+  return FALSE;
+}
+
+
+
+static void
+pulseaudio_spectrum_map (GtkWidget *widget)
+{
+  PulseaudioSpectrum *spectrum = PULSEAUDIO_SPECTRUM (widget);
+
+  (*GTK_WIDGET_CLASS (pulseaudio_spectrum_parent_class)->map) (widget);
+
+  /* capture only while visible */
+  spectrum->capture = pulseaudio_volume_new_capture (spectrum->volume, PULSEAUDIO_ANALYZER_RATE);
+  spectrum->last_frame_time = 0;
+  spectrum->busy = 0;
+  spectrum->n_frames = 0;
+  if (spectrum->capture != NULL)
+    spectrum->tick_id = gtk_widget_add_tick_callback (widget, pulseaudio_spectrum_tick, NULL, NULL);
+}
+
+
+
+static void
+pulseaudio_spectrum_unmap (GtkWidget *widget)
+{
+  PulseaudioSpectrum *spectrum = PULSEAUDIO_SPECTRUM (widget);
+  guint               i;
+
+  if (spectrum->tick_id != 0)
+    {
+      gtk_widget_remove_tick_callback (widget, spectrum->tick_id);
+      spectrum->tick_id = 0;
+    }
+
+  if (spectrum->capture != NULL)
+    {
+      g_object_unref (G_OBJECT (spectrum->capture));
+      spectrum->capture = NULL;
+    }
+
+  if (spectrum->n_frames > 0)
+    pulseaudio_debug ("Spectrum: %u frames, %.1f us per frame",
+                      spectrum->n_frames, (gdouble) spectrum->busy / spectrum->n_frames);
+
+  for (i = 0; i < SPECTRUM_N_BANDS; i++)
+    spectrum->bands[i] = 0.0f;
+
+  (*GTK_WIDGET_CLASS (pulseaudio_spectrum_parent_class)->unmap) (widget);
+}
+
+
+
+GtkWidget *
+pulseaudio_spectrum_new (PulseaudioVolume *volume)
+{
+  PulseaudioSpectrum *spectrum;
+
+  g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), NULL);
+
+  spectrum = g_object_new (TYPE_PULSEAUDIO_SPECTRUM, NULL);
+  spectrum->volume = volume;
+
+  return GTK_WIDGET (spectrum);
+}
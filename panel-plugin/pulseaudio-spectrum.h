@@ -0,0 +1,42 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __PULSEAUDIO_SPECTRUM_H__
+#define __PULSEAUDIO_SPECTRUM_H__
+
+#include <gtk/gtk.h>
+#include "pulseaudio-volume.h"
+
+G_BEGIN_DECLS
+
+#define TYPE_PULSEAUDIO_SPECTRUM             (pulseaudio_spectrum_get_type ())
+#define PULSEAUDIO_SPECTRUM(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), TYPE_PULSEAUDIO_SPECTRUM, PulseaudioSpectrum))
+#define PULSEAUDIO_SPECTRUM_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass),  TYPE_PULSEAUDIO_SPECTRUM, PulseaudioSpectrumClass))
+#define IS_PULSEAUDIO_SPECTRUM(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), TYPE_PULSEAUDIO_SPECTRUM))
+#define IS_PULSEAUDIO_SPECTRUM_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass),  TYPE_PULSEAUDIO_SPECTRUM))
+#define PULSEAUDIO_SPECTRUM_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj),  TYPE_PULSEAUDIO_SPECTRUM, PulseaudioSpectrumClass))
+
+typedef struct          _PulseaudioSpectrum                 PulseaudioSpectrum;
+typedef struct          _PulseaudioSpectrumClass            PulseaudioSpectrumClass;
+
+GType                   pulseaudio_spectrum_get_type        (void) G_GNUC_CONST;
+
+GtkWidget              *pulseaudio_spectrum_new             (PulseaudioVolume *volume);
+
+G_END_DECLS
+
+#endif /* !__PULSEAUDIO_SPECTRUM_H__ */
@@ -0,0 +1,371 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+
+/*
+ *  This file implements an entry of the stream registries kept by
+ *  PulseaudioVolume (sink inputs). Entries are updated in place and
+ *  emit "changed" only when one of the displayed fields changes.
+ *
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib-object.h>
+#include <pulse/pulseaudio.h>
+
+#include "pulseaudio-stream.h"
+
+
+static void                 pulseaudio_stream_finalize        (GObject            *object);
+
+
+struct _PulseaudioStream
+{
+  GObject               __parent__;
+
+  guint32               index;
+  guint32               device;
+  gchar                *name;
+  gchar                *icon_name;
+  gchar                *binary;
+  gchar                *app_id;
+  gdouble               volume;
+  gboolean              muted;
+  gboolean              corked;
+  pa_cvolume            cvolume;
+
+  /* pending volume write, at most one operation is in flight */
+  gdouble               volume_target;
+  gboolean              write_in_flight;
+  gboolean              write_queued;
+};
+
+struct _PulseaudioStreamClass
+{
+  GObjectClass          __parent__;
+};
+
+
+
+
+enum
+{
+  CHANGED,
+  LAST_SIGNAL
+};
+
+static guint pulseaudio_stream_signals[LAST_SIGNAL] = { 0, };
+
+
+
+
+G_DEFINE_TYPE (PulseaudioStream, pulseaudio_stream, G_TYPE_OBJECT)
+
+static void
+pulseaudio_stream_class_init (PulseaudioStreamClass *klass)
+{
+  GObjectClass      *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->finalize = pulseaudio_stream_finalize;
+
+  pulseaudio_stream_signals[CHANGED] =
+    g_signal_new (g_intern_static_string ("changed"),
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL,
+                  g_cclosure_marshal_VOID__VOID,
+                  G_TYPE_NONE, 0);
+}
+
+
+
+static void
+pulseaudio_stream_init (PulseaudioStream *stream)
+{
+  stream->index = PA_INVALID_INDEX;
+  stream->device = PA_INVALID_INDEX;
+  stream->name = NULL;
+  stream->icon_name = NULL;
+  stream->binary = NULL;
+  stream->app_id = NULL;
+  stream->volume = 0.0;
+  stream->muted = FALSE;
+  stream->corked = FALSE;
+  pa_cvolume_init (&stream->cvolume);
+  stream->volume_target = 0.0;
+  stream->write_in_flight = FALSE;
+  stream->write_queued = FALSE;
+}
+
+
+
+static void
+pulseaudio_stream_finalize (GObject *object)
+{
+  PulseaudioStream *stream = PULSEAUDIO_STREAM (object);
+
+  g_free (stream->name);
+  g_free (stream->icon_name);
+  g_free (stream->binary);
+  g_free (stream->app_id);
+
+  (*G_OBJECT_CLASS (pulseaudio_stream_parent_class)->finalize) (object);
+}
+
+
+
+guint32
+pulseaudio_stream_get_index (PulseaudioStream *stream)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_STREAM (stream), PA_INVALID_INDEX);
+
+  return stream->index;
+}
+
+
+
+guint32
+pulseaudio_stream_get_device (PulseaudioStream *stream)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_STREAM (stream), PA_INVALID_INDEX);
+
+  return stream->device;
+}
+
+
+
+const gchar *
+pulseaudio_stream_get_name (PulseaudioStream *stream)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_STREAM (stream), NULL);
+
+  return stream->name;
+}
+
+
+
+const gchar *
+pulseaudio_stream_get_icon_name (PulseaudioStream *stream)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_STREAM (stream), NULL);
+
+  return stream->icon_name;
+}
+
+
+
+const gchar *
+pulseaudio_stream_get_binary (PulseaudioStream *stream)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_STREAM (stream), NULL);
+
+  return stream->binary;
+}
+
+
+
+const gchar *
+pulseaudio_stream_get_app_id (PulseaudioStream *stream)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_STREAM (stream), NULL);
+
+  return stream->app_id;
+}
+
+
+
+gdouble
+pulseaudio_stream_get_volume (PulseaudioStream *stream)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_STREAM (stream), 0.0);
+
+  return stream->volume;
+}
+
+
+
+gboolean
+pulseaudio_stream_get_muted (PulseaudioStream *stream)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_STREAM (stream), FALSE);
+
+  return stream->muted;
+}
+
+
+
+gboolean
+pulseaudio_stream_get_corked (PulseaudioStream *stream)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_STREAM (stream), FALSE);
+
+  return stream->corked;
+}
+
+
+
+const pa_cvolume *
+pulseaudio_stream_get_cvolume (PulseaudioStream *stream)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_STREAM (stream), NULL);
+
+  return &stream->cvolume;
+}
+
+
+
+static gboolean
+pulseaudio_stream_set_string (gchar       **field,
+                              const gchar  *value)
+{
+  if (g_strcmp0 (*field, value) == 0)
+    return FALSE;
+
+  g_free (*field);
+  *field = g_strdup (value);
+  return TRUE;
+}
+
+
+
+void
+pulseaudio_stream_update (PulseaudioStream *stream,
+                          const gchar      *name,
+                          pa_proplist      *proplist,
+                          guint32           device,
+                          const pa_cvolume *cvolume,
+                          gdouble           volume,
+                          gboolean          muted,
+                          gboolean          corked)
+{
+  const gchar *app_name;
+  gboolean     changed = FALSE;
+
+  g_return_if_fail (IS_PULSEAUDIO_STREAM (stream));
+
+  /* prefer the application name over the media title */
+  app_name = pa_proplist_gets (proplist, PA_PROP_APPLICATION_NAME);
+  changed |= pulseaudio_stream_set_string (&stream->name, (app_name != NULL) ? app_name : name);
+  changed |= pulseaudio_stream_set_string (&stream->icon_name,
+                                           pa_proplist_gets (proplist, PA_PROP_APPLICATION_ICON_NAME));
+  changed |= pulseaudio_stream_set_string (&stream->binary,
+                                           pa_proplist_gets (proplist, PA_PROP_APPLICATION_PROCESS_BINARY));
+  changed |= pulseaudio_stream_set_string (&stream->app_id,
+                                           pa_proplist_gets (proplist, PA_PROP_APPLICATION_ID));
+
+  if (stream->device != device)
+    {
+      stream->device = device;
+      changed = TRUE;
+    }
+
+  if (cvolume != NULL)
+    stream->cvolume = *cvolume;
+
+  /* ignore intermediate values while our own write is pending */
+  if (!stream->write_in_flight && ABS (stream->volume - volume) > 2e-3)
+    {
+      stream->volume = volume;
+      changed = TRUE;
+    }
+
+  if (stream->muted != muted)
+    {
+      stream->muted = muted;
+      changed = TRUE;
+    }
+
+  if (stream->corked != corked)
+    {
+      stream->corked = corked;
+      changed = TRUE;
+    }
+
+  if (changed)
+    g_signal_emit (G_OBJECT (stream), pulseaudio_stream_signals [CHANGED], 0);
+}
+
+
+
+gdouble
+pulseaudio_stream_get_target_volume (PulseaudioStream *stream)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_STREAM (stream), 0.0);
+
+  if (stream->write_in_flight)
+    return stream->volume_target;
+
+  return stream->volume;
+}
+
+
+
+/* Records a new target volume. Returns TRUE if the caller should
+ * issue the write now, FALSE if it was queued behind the pending one. */
+gboolean
+pulseaudio_stream_begin_write (PulseaudioStream *stream,
+                               gdouble           target)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_STREAM (stream), FALSE);
+
+  stream->volume = target;
+  stream->volume_target = target;
+
+  if (stream->write_in_flight)
+    {
+      stream->write_queued = TRUE;
+      return FALSE;
+    }
+
+  stream->write_in_flight = TRUE;
+  return TRUE;
+}
+
+
+
+/* Completes the pending write. Returns TRUE if the caller should
+ * issue another one with the latest target. */
+gboolean
+pulseaudio_stream_end_write (PulseaudioStream *stream)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_STREAM (stream), FALSE);
+
+  stream->write_in_flight = stream->write_queued;
+  stream->write_queued = FALSE;
+
+  return stream->write_in_flight;
+}
+
+
+
+PulseaudioStream *
+pulseaudio_stream_new (guint32 index)
+{
+  PulseaudioStream *stream;
+
+  stream = g_object_new (TYPE_PULSEAUDIO_STREAM, NULL);
+  stream->index = index;
+
+  return stream;
+}
@@ -0,0 +1,67 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __PULSEAUDIO_STREAM_H__
+#define __PULSEAUDIO_STREAM_H__
+
+#include <glib-object.h>
+#include <pulse/pulseaudio.h>
+
+G_BEGIN_DECLS
+
+#define TYPE_PULSEAUDIO_STREAM             (pulseaudio_stream_get_type ())
+#define PULSEAUDIO_STREAM(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), TYPE_PULSEAUDIO_STREAM, PulseaudioStream))
+#define PULSEAUDIO_STREAM_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass),  TYPE_PULSEAUDIO_STREAM, PulseaudioStreamClass))
+#define IS_PULSEAUDIO_STREAM(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), TYPE_PULSEAUDIO_STREAM))
+#define IS_PULSEAUDIO_STREAM_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass),  TYPE_PULSEAUDIO_STREAM))
+#define PULSEAUDIO_STREAM_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj),  TYPE_PULSEAUDIO_STREAM, PulseaudioStreamClass))
+
+typedef struct          _PulseaudioStream                 PulseaudioStream;
+typedef struct          _PulseaudioStreamClass            PulseaudioStreamClass;
+
+GType                   pulseaudio_stream_get_type        (void) G_GNUC_CONST;
+
+PulseaudioStream       *pulseaudio_stream_new             (guint32           index);
+
+guint32                 pulseaudio_stream_get_index       (PulseaudioStream *stream);
+guint32                 pulseaudio_stream_get_device      (PulseaudioStream *stream);
+const gchar            *pulseaudio_stream_get_name        (PulseaudioStream *stream);
+const gchar            *pulseaudio_stream_get_icon_name   (PulseaudioStream *stream);
+const gchar            *pulseaudio_stream_get_binary      (PulseaudioStream *stream);
+const gchar            *pulseaudio_stream_get_app_id      (PulseaudioStream *stream);
+gdouble                 pulseaudio_stream_get_volume      (PulseaudioStream *stream);
+gboolean                pulseaudio_stream_get_muted       (PulseaudioStream *stream);
+gboolean                pulseaudio_stream_get_corked      (PulseaudioStream *stream);
+const pa_cvolume       *pulseaudio_stream_get_cvolume     (PulseaudioStream *stream);
+
+void                    pulseaudio_stream_update          (PulseaudioStream *stream,
+                                                           const gchar      *name,
+                                                           pa_proplist      *proplist,
+                                                           guint32           device,
+                                                           const pa_cvolume *cvolume,
+                                                           gdouble           volume,
+                                                           gboolean          muted,
+                                                           gboolean          corked);
+
+gdouble                 pulseaudio_stream_get_target_volume (PulseaudioStream *stream);
+gboolean                pulseaudio_stream_begin_write     (PulseaudioStream *stream,
+                                                           gdouble           target);
+gboolean                pulseaudio_stream_end_write       (PulseaudioStream *stream);
+
+G_END_DECLS
+
+#endif /* !__PULSEAUDIO_STREAM_H__ */
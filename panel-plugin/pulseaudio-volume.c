@@ -29,16 +29,49 @@
 #include <config.h>
 #endif
 
+#ifdef HAVE_MATH_H
+#include <math.h>
+#endif
+
+#include <gio/gio.h>
 #include <pulse/pulseaudio.h>
 #include <pulse/glib-mainloop.h>
 
+#include "pulseaudio-card.h"
 #include "pulseaudio-config.h"
 #include "pulseaudio-debug.h"
+#include "pulseaudio-meter.h"
+#include "pulseaudio-sink.h"
+#include "pulseaudio-stream.h"
 #include "pulseaudio-volume.h"
 
 
+/* Events needed to keep the volume and recording state current */
+#define PULSEAUDIO_VOLUME_MASK_REQUIRED (PA_SUBSCRIPTION_MASK_SINK | PA_SUBSCRIPTION_MASK_SERVER | PA_SUBSCRIPTION_MASK_CARD | PA_SUBSCRIPTION_MASK_SOURCE_OUTPUT)
+/* Events only of interest while some of the UI is visible */
+#define PULSEAUDIO_VOLUME_MASK_OPTIONAL (PA_SUBSCRIPTION_MASK_SINK_INPUT | PA_SUBSCRIPTION_MASK_SOURCE)
+
+/* Feedback tick kept in the server's sample cache */
+#define PULSEAUDIO_VOLUME_FEEDBACK_NAME     "xfce4-pulseaudio-plugin-feedback"
+#define PULSEAUDIO_VOLUME_FEEDBACK_RATE     44100
+#define PULSEAUDIO_VOLUME_FEEDBACK_FRAMES   (PULSEAUDIO_VOLUME_FEEDBACK_RATE / 25)
+/* Steps closer together than this play a single tick */
+#define PULSEAUDIO_VOLUME_FEEDBACK_INTERVAL (G_USEC_PER_SEC / 12)
+
+/* Entries of the volume curve table per 100% of slider range */
+#define PULSEAUDIO_VOLUME_CURVE_RES 1000
+
+/* Ramp timer period, about one frame at 60 Hz */
+#define PULSEAUDIO_VOLUME_RAMP_TICK 16
+
+
 static void                 pulseaudio_volume_finalize        (GObject            *object);
 static void                 pulseaudio_volume_connect         (PulseaudioVolume   *volume);
+static void                 pulseaudio_volume_write_volume    (PulseaudioVolume   *volume);
+static void                 pulseaudio_volume_update_subscription (PulseaudioVolume *volume);
+static void                 pulseaudio_volume_sink_input_sync (PulseaudioVolume *volume);
+static void                 pulseaudio_volume_feedback_upload (PulseaudioVolume *volume);
+static void                 pulseaudio_volume_ramp_stop       (PulseaudioVolume   *volume);
 static gdouble              pulseaudio_volume_v2d             (PulseaudioVolume   *volume,
                                                                pa_volume_t         vol);
 static pa_volume_t          pulseaudio_volume_d2v             (PulseaudioVolume   *volume,
@@ -57,11 +90,66 @@ struct _PulseaudioVolume
 
   gdouble               volume;
   gboolean              muted;
+  gdouble               balance;
+
+  /* slider position to pa_volume_t, sampled every 1/CURVE_RES and
+   * rebuilt when the curve or the maximum volume changes */
+  pa_volume_t          *curve;
+  guint                 curve_len;
+  gdouble               vol_max;
+
+  /* pending volume write, at most one operation is in flight */
+  gdouble               volume_target;
+  gboolean              write_in_flight;
+  gboolean              write_queued;
+  guint                 writes;
+
+  /* ramp towards ramp_to, driven by a timer while it runs */
+  guint                 ramp_timeout_id;
+  gdouble               ramp_from;
+  gdouble               ramp_to;
+  gint64                ramp_start;
+  guint                 ramp_ticks;
+  guint                 ramp_writes;
+
+  /* number of visible UI elements */
+  guint                 ui_visible;
 
   gdouble               volume_mic;
   gboolean              muted_mic;
 
-
+  /* sink registry, the store keeps the entries sorted by index */
+  GListStore           *sinks;
+  GHashTable           *sinks_by_index;
+  gchar                *default_sink_name;
+  gchar                *monitor_source_name;
+  /* whether the default sink is playing rather than idle or suspended */
+  gboolean              sink_running;
+  /* latest latency sample of the default sink, in usec */
+  pa_usec_t             sink_latency;
+  pa_usec_t             sink_configured_latency;
+
+  /* sink input registry, kept like the sink registry */
+  GListStore           *sink_inputs;
+  GHashTable           *sink_inputs_by_index;
+  /* indices reported by a full listing in progress */
+  GHashTable           *sink_inputs_seen;
+
+  /* recording streams (source outputs), kept like the sink registry */
+  GListStore           *source_outputs;
+  GHashTable           *source_outputs_by_index;
+
+  /* card registry, kept like the sink registry */
+  GListStore           *cards;
+  GHashTable           *cards_by_index;
+
+  /* operations of the current batch still in flight */
+  guint                 batch_pending;
+
+  /* upload of the feedback sample, done once per connection */
+  pa_stream            *feedback_stream;
+  gboolean              feedback_uploaded;
+  gint64                feedback_last;
 };
 
 struct _PulseaudioVolumeClass
@@ -75,6 +163,8 @@ struct _PulseaudioVolumeClass
 enum
 {
   VOLUME_CHANGED,
+  SINK_RUNNING_CHANGED,
+  LATENCY_SAMPLED,
   LAST_SIGNAL
 };
 
@@ -101,6 +191,21 @@ pulseaudio_volume_class_init (PulseaudioVolumeClass *klass)
                   g_cclosure_marshal_VOID__VOID,
                   G_TYPE_NONE, 0);
 
+  pulseaudio_volume_signals[SINK_RUNNING_CHANGED] =
+    g_signal_new (g_intern_static_string ("sink-running-changed"),
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL,
+                  g_cclosure_marshal_VOID__VOID,
+                  G_TYPE_NONE, 0);
+
+  pulseaudio_volume_signals[LATENCY_SAMPLED] =
+    g_signal_new (g_intern_static_string ("latency-sampled"),
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL,
+                  g_cclosure_marshal_VOID__VOID,
+                  G_TYPE_NONE, 0);
 }
 
 
@@ -111,6 +216,41 @@ pulseaudio_volume_init (PulseaudioVolume *volume)
   volume->connected = FALSE;
   volume->volume = 0.0;
   volume->muted = FALSE;
+  volume->balance = 0.0;
+  volume->curve = NULL;
+  volume->curve_len = 0;
+  volume->vol_max = 1.0;
+  volume->volume_target = 0.0;
+  volume->write_in_flight = FALSE;
+  volume->write_queued = FALSE;
+  volume->writes = 0;
+  volume->ramp_timeout_id = 0;
+  volume->ramp_from = 0.0;
+  volume->ramp_to = 0.0;
+  volume->ramp_start = 0;
+  volume->ramp_ticks = 0;
+  volume->ramp_writes = 0;
+  volume->ui_visible = 0;
+
+  volume->sinks = g_list_store_new (TYPE_PULSEAUDIO_SINK);
+  volume->sinks_by_index = g_hash_table_new (g_direct_hash, g_direct_equal);
+  volume->default_sink_name = NULL;
+  volume->monitor_source_name = NULL;
+  volume->sink_running = FALSE;
+  volume->sink_latency = 0;
+  volume->sink_configured_latency = 0;
+
+  volume->sink_inputs = g_list_store_new (TYPE_PULSEAUDIO_STREAM);
+  volume->sink_inputs_by_index = g_hash_table_new (g_direct_hash, g_direct_equal);
+  volume->sink_inputs_seen = NULL;
+  volume->source_outputs = g_list_store_new (TYPE_PULSEAUDIO_STREAM);
+  volume->source_outputs_by_index = g_hash_table_new (g_direct_hash, g_direct_equal);
+  volume->cards = g_list_store_new (TYPE_PULSEAUDIO_CARD);
+  volume->cards_by_index = g_hash_table_new (g_direct_hash, g_direct_equal);
+  volume->batch_pending = 0;
+  volume->feedback_stream = NULL;
+  volume->feedback_uploaded = FALSE;
+  volume->feedback_last = 0;
 
   volume->pa_mainloop = pa_glib_mainloop_new (NULL);
 
@@ -124,16 +264,396 @@ pulseaudio_volume_finalize (GObject *object)
 {
   PulseaudioVolume *volume = PULSEAUDIO_VOLUME (object);
 
+  if (volume->config != NULL)
+    g_signal_handlers_disconnect_by_data (G_OBJECT (volume->config), volume);
   volume->config = NULL;
 
+  if (volume->feedback_stream != NULL)
+    {
+      pa_stream_set_state_callback (volume->feedback_stream, NULL, NULL);
+      pa_stream_unref (volume->feedback_stream);
+    }
+
   pa_glib_mainloop_free (volume->pa_mainloop);
 
+  g_hash_table_destroy (volume->sinks_by_index);
+  g_object_unref (G_OBJECT (volume->sinks));
+  g_free (volume->default_sink_name);
+  g_free (volume->monitor_source_name);
+
+  g_hash_table_destroy (volume->sink_inputs_by_index);
+  g_object_unref (G_OBJECT (volume->sink_inputs));
+  if (volume->sink_inputs_seen != NULL)
+    g_hash_table_destroy (volume->sink_inputs_seen);
+
+  g_hash_table_destroy (volume->source_outputs_by_index);
+  g_object_unref (G_OBJECT (volume->source_outputs));
+
+  g_free (volume->curve);
+
+  if (volume->ramp_timeout_id != 0)
+    g_source_remove (volume->ramp_timeout_id);
+
+  g_hash_table_destroy (volume->cards_by_index);
+  g_object_unref (G_OBJECT (volume->cards));
+
   (*G_OBJECT_CLASS (pulseaudio_volume_parent_class)->finalize) (object);
 }
 
 
 
 
+static gint
+pulseaudio_volume_sink_compare (gconstpointer a,
+                                gconstpointer b,
+                                gpointer      user_data)
+{
+  guint32 index_a = pulseaudio_sink_get_index (PULSEAUDIO_SINK (a));
+  guint32 index_b = pulseaudio_sink_get_index (PULSEAUDIO_SINK (b));
+
+  return (index_a > index_b) - (index_a < index_b);
+}
+
+
+
+/* updates a single registry entry in place */
+static void
+pulseaudio_volume_update_sink (PulseaudioVolume   *volume,
+                               const pa_sink_info *i)
+{
+  PulseaudioSink *sink;
+  gboolean        is_new = FALSE;
+
+  sink = g_hash_table_lookup (volume->sinks_by_index, GUINT_TO_POINTER (i->index));
+  if (sink == NULL)
+    {
+      sink = pulseaudio_sink_new (i->index);
+      is_new = TRUE;
+    }
+
+  pulseaudio_sink_update (sink, i->name, i->description,
+                          pulseaudio_volume_v2d (volume, pa_cvolume_max (&i->volume)),
+                          (gboolean) i->mute, i->card,
+                          (i->active_port != NULL) ? i->active_port->name : NULL);
+  pulseaudio_sink_update_ports (sink, i->ports, i->n_ports);
+  pulseaudio_sink_set_default (sink, g_strcmp0 (i->name, volume->default_sink_name) == 0);
+
+  if (is_new)
+    {
+      pulseaudio_debug ("Added sink %u: %s", i->index, i->name);
+      g_hash_table_insert (volume->sinks_by_index, GUINT_TO_POINTER (i->index), sink);
+      g_list_store_insert_sorted (volume->sinks, sink, pulseaudio_volume_sink_compare, NULL);
+      g_object_unref (G_OBJECT (sink));
+    }
+}
+
+
+
+static void
+pulseaudio_volume_store_remove (GListStore *store,
+                                gpointer    entry)
+{
+  guint     n_items;
+  guint     position;
+  gpointer  item;
+
+  n_items = g_list_model_get_n_items (G_LIST_MODEL (store));
+  for (position = 0; position < n_items; position++)
+    {
+      item = g_list_model_get_item (G_LIST_MODEL (store), position);
+      g_object_unref (item);
+      if (item == entry)
+        {
+          g_list_store_remove (store, position);
+          break;
+        }
+    }
+}
+
+
+
+static void
+pulseaudio_volume_remove_sink (PulseaudioVolume *volume,
+                               guint32           index)
+{
+  PulseaudioSink *sink;
+
+  sink = g_hash_table_lookup (volume->sinks_by_index, GUINT_TO_POINTER (index));
+  if (sink == NULL)
+    return;
+
+  pulseaudio_debug ("Removed sink %u", index);
+  g_hash_table_remove (volume->sinks_by_index, GUINT_TO_POINTER (index));
+  pulseaudio_volume_store_remove (volume->sinks, sink);
+}
+
+
+
+static gint
+pulseaudio_volume_stream_compare (gconstpointer a,
+                                  gconstpointer b,
+                                  gpointer      user_data)
+{
+  guint32 index_a = pulseaudio_stream_get_index (PULSEAUDIO_STREAM (a));
+  guint32 index_b = pulseaudio_stream_get_index (PULSEAUDIO_STREAM (b));
+
+  return (index_a > index_b) - (index_a < index_b);
+}
+
+
+
+static void
+pulseaudio_volume_remove_sink_input (PulseaudioVolume *volume,
+                                     guint32           index)
+{
+  PulseaudioStream *stream;
+
+  stream = g_hash_table_lookup (volume->sink_inputs_by_index, GUINT_TO_POINTER (index));
+  if (stream == NULL)
+    return;
+
+  pulseaudio_debug ("Removed sink input %u", index);
+  g_hash_table_remove (volume->sink_inputs_by_index, GUINT_TO_POINTER (index));
+  pulseaudio_volume_store_remove (volume->sink_inputs, stream);
+}
+
+
+
+/* sink input event callbacks */
+static void
+pulseaudio_volume_sink_input_info_cb (pa_context               *context,
+                                      const pa_sink_input_info *i,
+                                      int                       eol,
+                                      void                     *userdata)
+{
+  PulseaudioStream *stream;
+
+  PulseaudioVolume *volume = PULSEAUDIO_VOLUME (userdata);
+  if (i == NULL) return;
+
+  /* our own streams (event sounds) are not listed */
+  if (i->client != PA_INVALID_INDEX && i->client == pa_context_get_index (context))
+    return;
+
+  /* neither are the feedback ticks: the server plays them from the
+   * sample cache, so they have no client but carry the sample name */
+  if (i->client == PA_INVALID_INDEX &&
+      (g_strcmp0 (pa_proplist_gets (i->proplist, PA_PROP_EVENT_ID), PULSEAUDIO_VOLUME_FEEDBACK_NAME) == 0 ||
+       g_strcmp0 (pa_proplist_gets (i->proplist, PA_PROP_MEDIA_NAME), PULSEAUDIO_VOLUME_FEEDBACK_NAME) == 0))
+    return;
+
+  stream = g_hash_table_lookup (volume->sink_inputs_by_index, GUINT_TO_POINTER (i->index));
+  if (stream != NULL)
+    {
+      pulseaudio_stream_update (stream, i->name, i->proplist, i->sink, &i->volume,
+                                pulseaudio_volume_v2d (volume, pa_cvolume_max (&i->volume)),
+                                (gboolean) i->mute, (gboolean) i->corked);
+      return;
+    }
+
+  stream = pulseaudio_stream_new (i->index);
+  pulseaudio_stream_update (stream, i->name, i->proplist, i->sink, &i->volume,
+                            pulseaudio_volume_v2d (volume, pa_cvolume_max (&i->volume)),
+                            (gboolean) i->mute, (gboolean) i->corked);
+
+  pulseaudio_debug ("Added sink input %u: %s", i->index, pulseaudio_stream_get_name (stream));
+  g_hash_table_insert (volume->sink_inputs_by_index, GUINT_TO_POINTER (i->index), stream);
+  g_list_store_insert_sorted (volume->sink_inputs, stream, pulseaudio_volume_stream_compare, NULL);
+  g_object_unref (G_OBJECT (stream));
+}
+
+
+
+/* Only the terminator of the full listing may sweep, replies to single
+ * index queries can finish while the listing is still running */
+static void
+pulseaudio_volume_sink_input_list_cb (pa_context               *context,
+                                      const pa_sink_input_info *i,
+                                      int                       eol,
+                                      void                     *userdata)
+{
+  GHashTableIter    iter;
+  gpointer          key;
+  guint32           index;
+  GArray           *stale;
+  guint             n;
+
+  PulseaudioVolume *volume = PULSEAUDIO_VOLUME (userdata);
+
+  if (volume->sink_inputs_seen == NULL)
+    return;
+
+  if (i != NULL)
+    {
+      g_hash_table_add (volume->sink_inputs_seen, GUINT_TO_POINTER (i->index));
+      pulseaudio_volume_sink_input_info_cb (context, i, eol, userdata);
+      return;
+    }
+
+  /* end of the listing, drop the entries it did not report */
+  if (eol > 0)
+    {
+      stale = g_array_new (FALSE, FALSE, sizeof (guint32));
+      g_hash_table_iter_init (&iter, volume->sink_inputs_by_index);
+      while (g_hash_table_iter_next (&iter, &key, NULL))
+        if (!g_hash_table_contains (volume->sink_inputs_seen, key))
+          {
+            index = GPOINTER_TO_UINT (key);
+            g_array_append_val (stale, index);
+          }
+
+      for (n = 0; n < stale->len; n++)
+        pulseaudio_volume_remove_sink_input (volume, g_array_index (stale, guint32, n));
+
+      g_array_free (stale, TRUE);
+    }
+
+  g_hash_table_destroy (volume->sink_inputs_seen);
+  volume->sink_inputs_seen = NULL;
+}
+
+
+
+static void
+pulseaudio_volume_remove_source_output (PulseaudioVolume *volume,
+                                        guint32           index)
+{
+  PulseaudioStream *stream;
+
+  stream = g_hash_table_lookup (volume->source_outputs_by_index, GUINT_TO_POINTER (index));
+  if (stream == NULL)
+    return;
+
+  pulseaudio_debug ("Removed source output %u", index);
+  g_hash_table_remove (volume->source_outputs_by_index, GUINT_TO_POINTER (index));
+  pulseaudio_volume_store_remove (volume->source_outputs, stream);
+}
+
+
+
+/* source output event callbacks */
+static void
+pulseaudio_volume_source_output_info_cb (pa_context                  *context,
+                                         const pa_source_output_info *i,
+                                         int                          eol,
+                                         void                        *userdata)
+{
+  PulseaudioStream *stream;
+
+  PulseaudioVolume *volume = PULSEAUDIO_VOLUME (userdata);
+  if (i == NULL) return;
+
+  /* our own meters and the peak monitors of other mixers are not recordings */
+  if ((i->client != PA_INVALID_INDEX && i->client == pa_context_get_index (context)) ||
+      g_strcmp0 (i->resample_method, "peaks") == 0)
+    return;
+
+  stream = g_hash_table_lookup (volume->source_outputs_by_index, GUINT_TO_POINTER (i->index));
+  if (stream != NULL)
+    {
+      pulseaudio_stream_update (stream, i->name, i->proplist, i->source, &i->volume,
+                                pulseaudio_volume_v2d (volume, pa_cvolume_max (&i->volume)),
+                                (gboolean) i->mute, (gboolean) i->corked);
+      return;
+    }
+
+  stream = pulseaudio_stream_new (i->index);
+  pulseaudio_stream_update (stream, i->name, i->proplist, i->source, &i->volume,
+                            pulseaudio_volume_v2d (volume, pa_cvolume_max (&i->volume)),
+                            (gboolean) i->mute, (gboolean) i->corked);
+
+  pulseaudio_debug ("Added source output %u: %s", i->index, pulseaudio_stream_get_name (stream));
+  g_hash_table_insert (volume->source_outputs_by_index, GUINT_TO_POINTER (i->index), stream);
+  g_list_store_insert_sorted (volume->source_outputs, stream, pulseaudio_volume_stream_compare, NULL);
+  g_object_unref (G_OBJECT (stream));
+}
+
+
+
+/* reconciles the registry with a full listing, used after events were missed */
+static void
+pulseaudio_volume_sink_input_sync (PulseaudioVolume *volume)
+{
+  pa_operation *op;
+
+  if (!volume->connected || volume->sink_inputs_seen != NULL)
+    return;
+
+  volume->sink_inputs_seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+  op = pa_context_get_sink_input_info_list (volume->pa_context, pulseaudio_volume_sink_input_list_cb, volume);
+  if (op != NULL)
+    {
+      pa_operation_unref (op);
+    }
+  else
+    {
+      g_hash_table_destroy (volume->sink_inputs_seen);
+      volume->sink_inputs_seen = NULL;
+    }
+}
+
+
+
+static gint
+pulseaudio_volume_card_compare (gconstpointer a,
+                                gconstpointer b,
+                                gpointer      user_data)
+{
+  guint32 index_a = pulseaudio_card_get_index (PULSEAUDIO_CARD (a));
+  guint32 index_b = pulseaudio_card_get_index (PULSEAUDIO_CARD (b));
+
+  return (index_a > index_b) - (index_a < index_b);
+}
+
+
+
+static void
+pulseaudio_volume_remove_card (PulseaudioVolume *volume,
+                               guint32           index)
+{
+  PulseaudioCard *card;
+
+  card = g_hash_table_lookup (volume->cards_by_index, GUINT_TO_POINTER (index));
+  if (card == NULL)
+    return;
+
+  pulseaudio_debug ("Removed card %u", index);
+  g_hash_table_remove (volume->cards_by_index, GUINT_TO_POINTER (index));
+  pulseaudio_volume_store_remove (volume->cards, card);
+}
+
+
+
+/* card event callbacks */
+static void
+pulseaudio_volume_card_info_cb (pa_context         *context,
+                                const pa_card_info *i,
+                                int                 eol,
+                                void               *userdata)
+{
+  PulseaudioCard *card;
+
+  PulseaudioVolume *volume = PULSEAUDIO_VOLUME (userdata);
+  if (i == NULL) return;
+
+  card = g_hash_table_lookup (volume->cards_by_index, GUINT_TO_POINTER (i->index));
+  if (card != NULL)
+    {
+      pulseaudio_card_update (card, i);
+      return;
+    }
+
+  card = pulseaudio_card_new (i->index);
+  pulseaudio_card_update (card, i);
+
+  pulseaudio_debug ("Added card %u: %s", i->index, i->name);
+  g_hash_table_insert (volume->cards_by_index, GUINT_TO_POINTER (i->index), card);
+  g_list_store_insert_sorted (volume->cards, card, pulseaudio_volume_card_compare, NULL);
+  g_object_unref (G_OBJECT (card));
+}
+
+
+
 /* sink event callbacks */
 static void
 pulseaudio_volume_sink_info_cb (pa_context         *context,
@@ -143,12 +663,33 @@ pulseaudio_volume_sink_info_cb (pa_context         *context,
 {
   gboolean  muted;
   gdouble   vol;
+  gdouble   balance;
 
   PulseaudioVolume *volume = PULSEAUDIO_VOLUME (userdata);
   if (i == NULL) return;
 
+  pulseaudio_volume_update_sink (volume, i);
+
+  /* the remaining state follows the default sink only */
+  if (g_strcmp0 (i->name, volume->default_sink_name) != 0)
+    return;
+
+  if (g_strcmp0 (volume->monitor_source_name, i->monitor_source_name) != 0)
+    {
+      g_free (volume->monitor_source_name);
+      volume->monitor_source_name = g_strdup (i->monitor_source_name);
+    }
+
+  if (volume->sink_running != (i->state == PA_SINK_RUNNING))
+    {
+      volume->sink_running = (i->state == PA_SINK_RUNNING);
+      pulseaudio_debug ("Default sink %s", volume->sink_running ? "running" : "idle");
+      g_signal_emit (G_OBJECT (volume), pulseaudio_volume_signals [SINK_RUNNING_CHANGED], 0);
+    }
+
   muted = (gboolean) i->mute;
-  vol = pulseaudio_volume_v2d (volume, i->volume.values[0]);
+  vol = pulseaudio_volume_v2d (volume, pa_cvolume_max (&i->volume));
+  balance = pa_cvolume_get_balance (&i->volume, &i->channel_map);
 
   if (volume->muted != muted)
     {
@@ -157,12 +698,20 @@ pulseaudio_volume_sink_info_cb (pa_context         *context,
       g_signal_emit (G_OBJECT (volume), pulseaudio_volume_signals [VOLUME_CHANGED], 0);
     }
 
-  if (ABS (volume->volume - vol) > 2e-3)
+  /* ignore intermediate values while our own write is pending */
+  if (!volume->write_in_flight && ABS (volume->volume - vol) > 2e-3)
     {
       pulseaudio_debug ("Updated Volume: %04.3f -> %04.3f", volume->volume, vol);
       volume->volume = vol;
       g_signal_emit (G_OBJECT (volume), pulseaudio_volume_signals [VOLUME_CHANGED], 0);
     }
+
+  if (ABS (volume->balance - balance) > 2e-3)
+    {
+      pulseaudio_debug ("Updated Balance: %04.3f -> %04.3f", volume->balance, balance);
+      volume->balance = balance;
+      g_signal_emit (G_OBJECT (volume), pulseaudio_volume_signals [VOLUME_CHANGED], 0);
+    }
 }
 
 
@@ -172,10 +721,25 @@ pulseaudio_volume_server_info_cb (pa_context           *context,
                                   const pa_server_info *i,
                                   void                 *userdata)
 {
+  GHashTableIter  iter;
+  gpointer        sink;
+
   PulseaudioVolume *volume = PULSEAUDIO_VOLUME (userdata);
   if (i == NULL) return;
 
-  pulseaudio_debug ("default sink name = %s\n", i->default_sink_name);
+  if (g_strcmp0 (volume->default_sink_name, i->default_sink_name) != 0)
+    {
+      pulseaudio_debug ("default sink name = %s\n", i->default_sink_name);
+      g_free (volume->default_sink_name);
+      volume->default_sink_name = g_strdup (i->default_sink_name);
+
+      g_hash_table_iter_init (&iter, volume->sinks_by_index);
+      while (g_hash_table_iter_next (&iter, NULL, &sink))
+        pulseaudio_sink_set_default (PULSEAUDIO_SINK (sink),
+                                     g_strcmp0 (pulseaudio_sink_get_name (PULSEAUDIO_SINK (sink)),
+                                                volume->default_sink_name) == 0);
+    }
+
   pa_context_get_sink_info_by_name (context, i->default_sink_name, pulseaudio_volume_sink_info_cb, volume);
 }
 
@@ -205,15 +769,46 @@ pulseaudio_volume_subscribe_cb (pa_context                   *context,
   switch (t & PA_SUBSCRIPTION_EVENT_FACILITY_MASK)
     {
     case PA_SUBSCRIPTION_EVENT_SINK          :
-      pulseaudio_volume_sink_check (volume, context);
+      /* only the affected registry entry is refreshed */
+      if ((t & PA_SUBSCRIPTION_EVENT_TYPE_MASK) == PA_SUBSCRIPTION_EVENT_REMOVE)
+        pulseaudio_volume_remove_sink (volume, idx);
+      else
+        pa_context_get_sink_info_by_index (context, idx, pulseaudio_volume_sink_info_cb, volume);
       pulseaudio_debug ("PulseAudio sink event");
       break;
 
+    case PA_SUBSCRIPTION_EVENT_SINK_INPUT    :
+      if ((t & PA_SUBSCRIPTION_EVENT_TYPE_MASK) == PA_SUBSCRIPTION_EVENT_REMOVE)
+        pulseaudio_volume_remove_sink_input (volume, idx);
+      /* changes caused by a batch are picked up once it completes */
+      else if (volume->batch_pending == 0)
+        pa_context_get_sink_input_info (context, idx, pulseaudio_volume_sink_input_info_cb, volume);
+      pulseaudio_debug ("PulseAudio sink input event");
+      break;
+
+    case PA_SUBSCRIPTION_EVENT_CARD          :
+      if ((t & PA_SUBSCRIPTION_EVENT_TYPE_MASK) == PA_SUBSCRIPTION_EVENT_REMOVE)
+        pulseaudio_volume_remove_card (volume, idx);
+      else
+        pa_context_get_card_info_by_index (context, idx, pulseaudio_volume_card_info_cb, volume);
+      pulseaudio_debug ("PulseAudio card event");
+      break;
+
+    case PA_SUBSCRIPTION_EVENT_SERVER        :
+      pulseaudio_volume_sink_check (volume, context);
+      pulseaudio_debug ("PulseAudio server event");
+      break;
+
     case PA_SUBSCRIPTION_EVENT_SOURCE        :
       pulseaudio_debug ("PulseAudio source event");
       break;
 
     case PA_SUBSCRIPTION_EVENT_SOURCE_OUTPUT :
+      /* always subscribed, so the registry never needs a full listing after startup */
+      if ((t & PA_SUBSCRIPTION_EVENT_TYPE_MASK) == PA_SUBSCRIPTION_EVENT_REMOVE)
+        pulseaudio_volume_remove_source_output (volume, idx);
+      else
+        pa_context_get_source_output_info (context, idx, pulseaudio_volume_source_output_info_cb, volume);
       pulseaudio_debug ("PulseAudio source output event");
       break;
 
@@ -235,17 +830,30 @@ pulseaudio_volume_context_state_cb (pa_context *context,
   switch (pa_context_get_state (context))
     {
     case PA_CONTEXT_READY        :
-      pa_context_subscribe (context, PA_SUBSCRIPTION_MASK_SINK | PA_SUBSCRIPTION_MASK_SOURCE | PA_SUBSCRIPTION_MASK_SOURCE_OUTPUT, NULL, NULL);
       pa_context_set_subscribe_callback (context, pulseaudio_volume_subscribe_cb, volume);
 
       pulseaudio_debug ("PulseAudio connection established");
       volume->connected = TRUE;
+      pulseaudio_volume_update_subscription (volume);
+      pa_context_get_sink_info_list (context, pulseaudio_volume_sink_info_cb, volume);
+      pa_context_get_card_info_list (context, pulseaudio_volume_card_info_cb, volume);
+      pa_context_get_source_output_info_list (context, pulseaudio_volume_source_output_info_cb, volume);
+      volume->feedback_uploaded = FALSE;
+      pulseaudio_volume_feedback_upload (volume);
       pulseaudio_volume_sink_check (volume, context);
+      if (volume->ui_visible > 0)
+        pulseaudio_volume_sink_input_sync (volume);
       break;
 
     case PA_CONTEXT_FAILED       :
     case PA_CONTEXT_TERMINATED   :
       g_warning ("Disconected from PulseAudio server");
+      pulseaudio_volume_ramp_stop (volume);
+      if (volume->sink_running)
+        {
+          volume->sink_running = FALSE;
+          g_signal_emit (G_OBJECT (volume), pulseaudio_volume_signals [SINK_RUNNING_CHANGED], 0);
+        }
       break;
 
     case PA_CONTEXT_CONNECTING   :
@@ -273,97 +881,403 @@ pulseaudio_volume_context_state_cb (pa_context *context,
 
 
 static void
-pulseaudio_volume_connect (PulseaudioVolume *volume)
-{
-  pa_proplist  *proplist;
-  gint          err;
-
-  g_return_if_fail (IS_PULSEAUDIO_VOLUME (volume));
-  g_return_if_fail (!volume->connected);
-
-  proplist = pa_proplist_new ();
-#ifdef HAVE_CONFIG_H
-  pa_proplist_sets (proplist, PA_PROP_APPLICATION_NAME, PACKAGE_NAME);
-  pa_proplist_sets (proplist, PA_PROP_APPLICATION_VERSION, PACKAGE_VERSION);
-  pa_proplist_sets (proplist, PA_PROP_APPLICATION_ID, "org.xfce.pulseaudio-plugin");
-  pa_proplist_sets (proplist, PA_PROP_APPLICATION_ICON_NAME, "multimedia-volume-control");
-#endif
-
-  volume->pa_context = pa_context_new_with_proplist (pa_glib_mainloop_get_api (volume->pa_mainloop), NULL, proplist);
-  pa_context_set_state_callback(volume->pa_context, pulseaudio_volume_context_state_cb, volume);
-
-  err = pa_context_connect (volume->pa_context, NULL, PA_CONTEXT_NOFAIL, NULL);
-  if (err < 0)
-    g_warning ("pa_context_connect() failed: %s", pa_strerror (err));
-  //g_warning ("pa_context_connect() failed: %s", pa_strerror (pa_context_errno (volume->pa_context)));
-}
-
-
-
-
-static gdouble
-pulseaudio_volume_v2d (PulseaudioVolume *volume,
-                       pa_volume_t       pa_volume)
+pulseaudio_volume_update_subscription (PulseaudioVolume *volume)
 {
-  gdouble vol;
-  gdouble vol_max;
+  pa_subscription_mask_t  mask = PULSEAUDIO_VOLUME_MASK_REQUIRED;
+  pa_operation           *op;
 
-  g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), 0.0);
+  if (!volume->connected)
+    return;
 
-  vol_max = pulseaudio_config_get_volume_max (volume->config) / 100.0;
+  if (volume->ui_visible > 0)
+    mask |= PULSEAUDIO_VOLUME_MASK_OPTIONAL;
 
-  vol = (gdouble) pa_volume - PA_VOLUME_MUTED;
-  vol /= (gdouble) (PA_VOLUME_NORM - PA_VOLUME_MUTED);
-  /* for safety */
-  vol = MIN (MAX (vol, 0.0), vol_max);
-  return vol;
+  op = pa_context_subscribe (volume->pa_context, mask, NULL, NULL);
+  if (op != NULL)
+    pa_operation_unref (op);
 }
 
 
 
-static pa_volume_t
-pulseaudio_volume_d2v (PulseaudioVolume *volume,
-                       gdouble           vol)
+/* Each call with visible set to TRUE must be paired with one with FALSE */
+void
+pulseaudio_volume_set_ui_visible (PulseaudioVolume *volume,
+                                  gboolean          visible)
 {
-  gdouble pa_volume;
+  g_return_if_fail (IS_PULSEAUDIO_VOLUME (volume));
+  g_return_if_fail (visible || volume->ui_visible > 0);
 
-  g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), PA_VOLUME_MUTED);
+  if (visible)
+    volume->ui_visible++;
+  else
+    volume->ui_visible--;
 
-  pa_volume = (PA_VOLUME_NORM - PA_VOLUME_MUTED) * vol;
-  pa_volume = (pa_volume_t) pa_volume + PA_VOLUME_MUTED;
-  /* for safety */
-  pa_volume = MIN (MAX (pa_volume, PA_VOLUME_MUTED), PA_VOLUME_MAX);
-  return pa_volume;
+  if (visible && volume->ui_visible == 1)
+    {
+      pulseaudio_debug ("UI visible, enabling optional subscriptions");
+      pulseaudio_volume_update_subscription (volume);
+      /* catch up with events missed while hidden */
+      if (volume->connected)
+        pulseaudio_volume_sink_check (volume, volume->pa_context);
+      pulseaudio_volume_sink_input_sync (volume);
+    }
+  else if (!visible && volume->ui_visible == 0)
+    {
+      pulseaudio_debug ("UI hidden, dropping optional subscriptions");
+      pulseaudio_volume_update_subscription (volume);
+    }
 }
 
 
 
-
 gboolean
-pulseaudio_volume_get_muted (PulseaudioVolume *volume)
+pulseaudio_volume_get_ui_visible (PulseaudioVolume *volume)
 {
   g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), FALSE);
 
-  return volume->muted;
+  return volume->ui_visible > 0;
 }
 
 
 
-/* final callback for volume/mute changes */
-/* pa_context_success_cb_t */
 static void
-pulseaudio_volume_sink_volume_changed (pa_context *context,
-                                       int         success,
-                                       void       *userdata)
+pulseaudio_volume_latency_cb (pa_context         *context,
+                              const pa_sink_info *i,
+                              int                 eol,
+                              void               *userdata)
 {
   PulseaudioVolume *volume = PULSEAUDIO_VOLUME (userdata);
+  if (i == NULL) return;
 
-  if (success)
-    g_signal_emit (G_OBJECT (volume), pulseaudio_volume_signals [VOLUME_CHANGED], 0);
+  volume->sink_latency = i->latency;
+  volume->sink_configured_latency = i->configured_latency;
+  g_signal_emit (G_OBJECT (volume), pulseaudio_volume_signals [LATENCY_SAMPLED], 0);
 }
 
-/* mute setting callbacks */
-/* pa_sink_info_cb_t */
+
+
+/* Queries the latency of the default sink, "latency-sampled" is emitted
+ * when the reply arrives. Meant to be polled only while it is shown. */
+void
+pulseaudio_volume_sample_latency (PulseaudioVolume *volume)
+{
+  pa_operation *op;
+
+  g_return_if_fail (IS_PULSEAUDIO_VOLUME (volume));
+
+  if (!volume->connected || volume->default_sink_name == NULL)
+    return;
+
+  op = pa_context_get_sink_info_by_name (volume->pa_context, volume->default_sink_name,
+                                         pulseaudio_volume_latency_cb, volume);
+  if (op != NULL)
+    pa_operation_unref (op);
+}
+
+
+
+guint64
+pulseaudio_volume_get_sink_latency (PulseaudioVolume *volume)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), 0);
+
+  return volume->sink_latency;
+}
+
+
+
+guint64
+pulseaudio_volume_get_sink_configured_latency (PulseaudioVolume *volume)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), 0);
+
+  return volume->sink_configured_latency;
+}
+
+
+
+gboolean
+pulseaudio_volume_get_sink_running (PulseaudioVolume *volume)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), FALSE);
+
+  return volume->sink_running;
+}
+
+
+
+static void
+pulseaudio_volume_feedback_state_cb (pa_stream *stream,
+                                     void      *userdata)
+{
+  PulseaudioVolume *volume = PULSEAUDIO_VOLUME (userdata);
+  gint16           *data;
+  guint             n;
+
+  switch (pa_stream_get_state (stream))
+    {
+    case PA_STREAM_READY:
+      /* a short decaying click, the server keeps it from now on */
+      data = g_new (gint16, PULSEAUDIO_VOLUME_FEEDBACK_FRAMES);
+      for (n = 0; n < PULSEAUDIO_VOLUME_FEEDBACK_FRAMES; n++)
+        data[n] = (gint16) (G_MAXINT16 * 0.3 *
+                            exp (-(gdouble) n / (PULSEAUDIO_VOLUME_FEEDBACK_FRAMES / 6)) *
+                            sin (2 * G_PI * 2000.0 * n / PULSEAUDIO_VOLUME_FEEDBACK_RATE));
+
+      pa_stream_write (stream, data, PULSEAUDIO_VOLUME_FEEDBACK_FRAMES * sizeof (gint16),
+                       g_free, 0, PA_SEEK_RELATIVE);
+      pa_stream_finish_upload (stream);
+      break;
+
+    case PA_STREAM_TERMINATED:
+      pulseaudio_debug ("Feedback sample uploaded");
+      volume->feedback_uploaded = TRUE;
+      pa_stream_unref (volume->feedback_stream);
+      volume->feedback_stream = NULL;
+      break;
+
+    case PA_STREAM_FAILED:
+      g_warning ("Failed to upload the feedback sample: %s",
+                 pa_strerror (pa_context_errno (volume->pa_context)));
+      pa_stream_unref (volume->feedback_stream);
+      volume->feedback_stream = NULL;
+      break;
+
+    default:
+      break;
+    }
+}
+
+
+
+static void
+pulseaudio_volume_feedback_upload (PulseaudioVolume *volume)
+{
+  pa_sample_spec ss;
+
+  if (!volume->connected || volume->feedback_uploaded || volume->feedback_stream != NULL ||
+      volume->config == NULL || !pulseaudio_config_get_play_feedback (volume->config))
+    return;
+
+  ss.format = PA_SAMPLE_S16NE;
+  ss.rate = PULSEAUDIO_VOLUME_FEEDBACK_RATE;
+  ss.channels = 1;
+
+  volume->feedback_stream = pa_stream_new (volume->pa_context, PULSEAUDIO_VOLUME_FEEDBACK_NAME, &ss, NULL);
+  if (volume->feedback_stream == NULL)
+    return;
+
+  pa_stream_set_state_callback (volume->feedback_stream, pulseaudio_volume_feedback_state_cb, volume);
+  if (pa_stream_connect_upload (volume->feedback_stream, PULSEAUDIO_VOLUME_FEEDBACK_FRAMES * sizeof (gint16)) < 0)
+    {
+      pa_stream_unref (volume->feedback_stream);
+      volume->feedback_stream = NULL;
+    }
+}
+
+
+
+/* Plays the cached tick on the default sink, a single small request */
+static void
+pulseaudio_volume_play_feedback (PulseaudioVolume *volume)
+{
+  pa_operation *op;
+  gint64        now;
+
+  if (!volume->feedback_uploaded || !pulseaudio_config_get_play_feedback (volume->config))
+    return;
+
+  now = g_get_monotonic_time ();
+  if (now - volume->feedback_last < PULSEAUDIO_VOLUME_FEEDBACK_INTERVAL)
+    return;
+  volume->feedback_last = now;
+
+  op = pa_context_play_sample (volume->pa_context, PULSEAUDIO_VOLUME_FEEDBACK_NAME,
+                               volume->default_sink_name, PA_VOLUME_NORM, NULL, NULL);
+  if (op != NULL)
+    pa_operation_unref (op);
+}
+
+
+
+static void
+pulseaudio_volume_connect (PulseaudioVolume *volume)
+{
+  pa_proplist  *proplist;
+  gint          err;
+
+  g_return_if_fail (IS_PULSEAUDIO_VOLUME (volume));
+  g_return_if_fail (!volume->connected);
+
+  proplist = pa_proplist_new ();
+#ifdef HAVE_CONFIG_H
+  pa_proplist_sets (proplist, PA_PROP_APPLICATION_NAME, PACKAGE_NAME);
+  pa_proplist_sets (proplist, PA_PROP_APPLICATION_VERSION, PACKAGE_VERSION);
+  pa_proplist_sets (proplist, PA_PROP_APPLICATION_ID, "org.xfce.pulseaudio-plugin");
+  pa_proplist_sets (proplist, PA_PROP_APPLICATION_ICON_NAME, "multimedia-volume-control");
+#endif
+
+  volume->pa_context = pa_context_new_with_proplist (pa_glib_mainloop_get_api (volume->pa_mainloop), NULL, proplist);
+  pa_context_set_state_callback(volume->pa_context, pulseaudio_volume_context_state_cb, volume);
+
+  err = pa_context_connect (volume->pa_context, NULL, PA_CONTEXT_NOFAIL, NULL);
+  if (err < 0)
+    g_warning ("pa_context_connect() failed: %s", pa_strerror (err));
+  //g_warning ("pa_context_connect() failed: %s", pa_strerror (pa_context_errno (volume->pa_context)));
+}
+
+
+
+
+/* pa_volume_t for a slider position, 1.0 being 100% */
+static pa_volume_t
+pulseaudio_volume_curve_eval (PulseaudioVolumeCurve curve,
+                              guint                 db_range,
+                              gdouble               vol)
+{
+  if (vol <= 0.0)
+    return PA_VOLUME_MUTED;
+
+  switch (curve)
+    {
+    case PULSEAUDIO_CURVE_CUBIC:
+      /* the slider follows the amplitude */
+      return pa_sw_volume_from_linear (vol);
+
+    case PULSEAUDIO_CURVE_DB:
+      /* evenly spaced decibels up to 0 dB at 100%, linear above it so
+       * the boost never exceeds the linear curve at volume-max */
+      if (vol < 1.0)
+        return pa_sw_volume_from_dB (db_range * (vol - 1.0));
+      return (pa_volume_t) (PA_VOLUME_NORM * vol);
+
+    case PULSEAUDIO_CURVE_LINEAR:
+    default:
+      return (pa_volume_t) ((PA_VOLUME_NORM - PA_VOLUME_MUTED) * vol) + PA_VOLUME_MUTED;
+    }
+}
+
+
+
+static void
+pulseaudio_volume_build_curve (PulseaudioVolume *volume)
+{
+  PulseaudioVolumeCurve curve;
+  guint                 db_range;
+  guint                 i;
+
+  curve = pulseaudio_config_get_volume_curve (volume->config);
+  db_range = pulseaudio_config_get_volume_db_range (volume->config);
+  volume->vol_max = pulseaudio_config_get_volume_max (volume->config) / 100.0;
+
+  volume->curve_len = pulseaudio_config_get_volume_max (volume->config) * PULSEAUDIO_VOLUME_CURVE_RES / 100 + 1;
+  volume->curve = g_renew (pa_volume_t, volume->curve, volume->curve_len);
+
+  for (i = 0; i < volume->curve_len; i++)
+    volume->curve[i] = MIN (pulseaudio_volume_curve_eval (curve, db_range, (gdouble) i / PULSEAUDIO_VOLUME_CURVE_RES),
+                            PA_VOLUME_MAX);
+
+  /* every entry must be above the previous one for the reverse lookup */
+  for (i = 1; i < volume->curve_len; i++)
+    volume->curve[i] = MAX (volume->curve[i], volume->curve[i - 1]);
+
+  pulseaudio_debug ("Volume curve %u rebuilt, %u entries", curve, volume->curve_len);
+}
+
+
+
+static void
+pulseaudio_volume_curve_changed (PulseaudioVolume *volume)
+{
+  pulseaudio_volume_build_curve (volume);
+
+  /* the same server volumes map to new slider positions, for the
+   * sinks and for the streams */
+  if (volume->connected)
+    {
+      pa_context_get_sink_info_list (volume->pa_context, pulseaudio_volume_sink_info_cb, volume);
+      pulseaudio_volume_sink_input_sync (volume);
+      pa_context_get_source_output_info_list (volume->pa_context, pulseaudio_volume_source_output_info_cb, volume);
+    }
+}
+
+
+
+static gdouble
+pulseaudio_volume_v2d (PulseaudioVolume *volume,
+                       pa_volume_t       pa_volume)
+{
+  const pa_volume_t *curve = volume->curve;
+  guint              lo, hi, mid;
+
+  if (pa_volume >= curve[volume->curve_len - 1])
+    return volume->vol_max;
+
+  /* last entry not above pa_volume */
+  lo = 0;
+  hi = volume->curve_len - 1;
+  while (hi - lo > 1)
+    {
+      mid = (lo + hi) / 2;
+      if (curve[mid] <= pa_volume)
+        lo = mid;
+      else
+        hi = mid;
+    }
+
+  if (curve[hi] == curve[lo])
+    return (gdouble) lo / PULSEAUDIO_VOLUME_CURVE_RES;
+
+  return (lo + (gdouble) (pa_volume - curve[lo]) / (curve[hi] - curve[lo])) / PULSEAUDIO_VOLUME_CURVE_RES;
+}
+
+
+
+static pa_volume_t
+pulseaudio_volume_d2v (PulseaudioVolume *volume,
+                       gdouble           vol)
+{
+  gdouble pos;
+  guint   i;
+
+  /* for safety */
+  pos = MIN (MAX (vol, 0.0), volume->vol_max) * PULSEAUDIO_VOLUME_CURVE_RES;
+  i = MIN ((guint) pos, volume->curve_len - 1);
+  if (i + 1 == volume->curve_len)
+    return volume->curve[i];
+
+  return volume->curve[i] + (pa_volume_t) ((pos - i) * (volume->curve[i + 1] - volume->curve[i]));
+}
+
+
+
+
+
+gboolean
+pulseaudio_volume_get_muted (PulseaudioVolume *volume)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), FALSE);
+
+  return volume->muted;
+}
+
+
+
+/* final callback for volume/mute changes */
+/* pa_context_success_cb_t */
+static void
+pulseaudio_volume_sink_volume_changed (pa_context *context,
+                                       int         success,
+                                       void       *userdata)
+{
+  PulseaudioVolume *volume = PULSEAUDIO_VOLUME (userdata);
+
+  if (success)
+    g_signal_emit (G_OBJECT (volume), pulseaudio_volume_signals [VOLUME_CHANGED], 0);
+}
+
+/* mute setting callbacks */
+/* pa_sink_info_cb_t */
 static void
 pulseaudio_volume_set_muted_cb1 (pa_context         *context,
                                  const pa_sink_info *i,
@@ -415,6 +1329,64 @@ pulseaudio_volume_get_volume (PulseaudioVolume *volume)
 
 
 
+/* The value last sent to the server, or on its way there */
+static gdouble
+pulseaudio_volume_get_pending_volume (PulseaudioVolume *volume)
+{
+  /* while a write is pending the server reported value lags behind */
+  if (volume->write_in_flight)
+    return volume->volume_target;
+
+  return volume->volume;
+}
+
+
+
+gdouble
+pulseaudio_volume_get_target_volume (PulseaudioVolume *volume)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), 0.0);
+
+  /* steps during a ramp add to where it is heading */
+  if (volume->ramp_timeout_id != 0)
+    return volume->ramp_to;
+
+  return pulseaudio_volume_get_pending_volume (volume);
+}
+
+
+
+/* pa_context_success_cb_t */
+static void
+pulseaudio_volume_set_volume_done (pa_context *context,
+                                   int         success,
+                                   void       *userdata)
+{
+  PulseaudioVolume *volume = PULSEAUDIO_VOLUME (userdata);
+
+  volume->write_in_flight = FALSE;
+
+  /* send the latest target, intermediate values are skipped */
+  if (volume->write_queued)
+    pulseaudio_volume_write_volume (volume);
+  else if (success)
+    g_signal_emit (G_OBJECT (volume), pulseaudio_volume_signals [VOLUME_CHANGED], 0);
+}
+
+
+
+/* A failed step must not strand a queued target */
+static void
+pulseaudio_volume_write_failed (PulseaudioVolume *volume)
+{
+  volume->write_in_flight = FALSE;
+
+  if (volume->write_queued)
+    pulseaudio_volume_write_volume (volume);
+}
+
+
+
 /* volume setting callbacks */
 /* pa_sink_info_cb_t */
 static void
@@ -424,13 +1396,26 @@ pulseaudio_volume_set_volume_cb2 (pa_context         *context,
                                   void               *userdata)
 {
   //char st[PA_CVOLUME_SNPRINT_MAX];
+  pa_cvolume    cv;
+  pa_operation *op;
 
   PulseaudioVolume *volume = PULSEAUDIO_VOLUME (userdata);
-  if (i == NULL) return;
+  if (i == NULL)
+    {
+      if (eol < 0)
+        pulseaudio_volume_write_failed (volume);
+      return;
+    }
 
   //pulseaudio_debug ("*** %s", pa_cvolume_snprint (st, sizeof (st), &i->volume));
-  pa_cvolume_set (&i->volume, 1, pulseaudio_volume_d2v (volume, volume->volume));
-  pa_context_set_sink_volume_by_index (context, i->index, &i->volume, pulseaudio_volume_sink_volume_changed, volume);
+  /* scaling keeps the channel balance intact */
+  cv = i->volume;
+  pa_cvolume_scale (&cv, pulseaudio_volume_d2v (volume, volume->volume_target));
+  op = pa_context_set_sink_volume_by_index (context, i->index, &cv, pulseaudio_volume_set_volume_done, volume);
+  if (op != NULL)
+    pa_operation_unref (op);
+  else
+    pulseaudio_volume_write_failed (volume);
 }
 
 
@@ -441,31 +1426,650 @@ pulseaudio_volume_set_volume_cb1 (pa_context           *context,
                                   const pa_server_info *i,
                                   void                 *userdata)
 {
+  pa_operation *op;
+
   PulseaudioVolume *volume = PULSEAUDIO_VOLUME (userdata);
-  if (i == NULL) return;
+  if (i == NULL)
+    {
+      pulseaudio_volume_write_failed (volume);
+      return;
+    }
+
+  op = pa_context_get_sink_info_by_name (context, i->default_sink_name, pulseaudio_volume_set_volume_cb2, volume);
+  if (op != NULL)
+    pa_operation_unref (op);
+  else
+    pulseaudio_volume_write_failed (volume);
+}
+
+
+
+static void
+pulseaudio_volume_write_volume (PulseaudioVolume *volume)
+{
+  pa_operation *op;
+
+  volume->write_in_flight = TRUE;
+  volume->write_queued = FALSE;
+  volume->writes++;
+
+  op = pa_context_get_server_info (volume->pa_context, pulseaudio_volume_set_volume_cb1, volume);
+  if (op != NULL)
+    pa_operation_unref (op);
+  else
+    pulseaudio_volume_write_failed (volume);
+}
+
+
+
+static void
+pulseaudio_volume_apply_volume (PulseaudioVolume *volume,
+                                gdouble           vol)
+{
+  if (pulseaudio_volume_get_pending_volume (volume) != vol)
+    {
+      volume->volume = vol;
+      volume->volume_target = vol;
+
+      /* keep at most one write in flight */
+      if (volume->write_in_flight)
+        volume->write_queued = TRUE;
+      else
+        pulseaudio_volume_write_volume (volume);
+    }
+}
+
+
+
+static void
+pulseaudio_volume_ramp_stop (PulseaudioVolume *volume)
+{
+  if (volume->ramp_timeout_id == 0)
+    return;
+
+  g_source_remove (volume->ramp_timeout_id);
+  volume->ramp_timeout_id = 0;
+
+  pulseaudio_debug ("Volume ramp cancelled: %u ticks, %u writes",
+                    volume->ramp_ticks, volume->writes - volume->ramp_writes);
+}
+
+
+
+static gboolean
+pulseaudio_volume_ramp_tick (gpointer user_data)
+{
+  PulseaudioVolume *volume = PULSEAUDIO_VOLUME (user_data);
+  gdouble           t;
+
+  t = (g_get_monotonic_time () - volume->ramp_start) /
+    (pulseaudio_config_get_volume_ramp_ms (volume->config) * 1000.0);
+  volume->ramp_ticks++;
 
-  pa_context_get_sink_info_by_name (context, i->default_sink_name, pulseaudio_volume_set_volume_cb2, volume);
+  /* a slow server skips intermediate values, see set_volume_done() */
+  if (t < 1.0)
+    {
+      /* ease out, the start of a change is what the ear notices */
+      t = 1.0 - (1.0 - t) * (1.0 - t);
+      pulseaudio_volume_apply_volume (volume, volume->ramp_from + (volume->ramp_to - volume->ramp_from) * t);
+      return G_SOURCE_CONTINUE;
+    }
+
+  pulseaudio_volume_apply_volume (volume, volume->ramp_to);
+  volume->ramp_timeout_id = 0;
+
+  pulseaudio_debug ("Volume ramp: %u ticks, %u writes",
+                    volume->ramp_ticks, volume->writes - volume->ramp_writes);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+
+/* Starts a ramp, or retargets a running one from where it is now */
+static void
+pulseaudio_volume_ramp_to (PulseaudioVolume *volume,
+                           gdouble           vol)
+{
+  if (volume->ramp_timeout_id == 0)
+    {
+      volume->ramp_ticks = 0;
+      volume->ramp_writes = volume->writes;
+      volume->ramp_timeout_id = g_timeout_add (PULSEAUDIO_VOLUME_RAMP_TICK, pulseaudio_volume_ramp_tick, volume);
+    }
+
+  volume->ramp_from = pulseaudio_volume_get_pending_volume (volume);
+  volume->ramp_to = MIN (MAX (vol, 0.0), volume->vol_max);
+  volume->ramp_start = g_get_monotonic_time ();
 }
 
 
+
 void
 pulseaudio_volume_set_volume (PulseaudioVolume *volume,
                               gdouble           vol)
 {
-  gdouble vol_max;
+  g_return_if_fail (IS_PULSEAUDIO_VOLUME (volume));
+  g_return_if_fail (pa_context_get_state (volume->pa_context) == PA_CONTEXT_READY);
+
+  /* a direct setting, e.g. from the slider, wins over a ramp */
+  pulseaudio_volume_ramp_stop (volume);
+
+  pulseaudio_volume_apply_volume (volume, MIN (MAX (vol, 0.0), volume->vol_max));
+}
+
+
+
+void
+pulseaudio_volume_step_volume (PulseaudioVolume *volume,
+                               gint              steps,
+                               gboolean          boost)
+{
+  gdouble vol;
+  gdouble vol_step;
+
+  g_return_if_fail (IS_PULSEAUDIO_VOLUME (volume));
+
+  if (steps == 0)
+    return;
+
+  /* step from the pending target so that no steps are lost */
+  vol = pulseaudio_volume_get_target_volume (volume);
+  vol_step = pulseaudio_config_get_volume_step (volume->config) / 100.0;
+
+  /* raising stops at 100% unless it is already exceeded or boosting
+   * is allowed; the result is trimmed to volume-max either way */
+  if (steps > 0 && !boost)
+    vol = MIN (vol + steps * vol_step, MAX (vol, 1.0));
+  else
+    vol = vol + steps * vol_step;
+
+  if (pulseaudio_config_get_volume_ramp_ms (volume->config) > 0
+      && pa_context_get_state (volume->pa_context) == PA_CONTEXT_READY)
+    pulseaudio_volume_ramp_to (volume, vol);
+  else
+    pulseaudio_volume_set_volume (volume, vol);
+
+  pulseaudio_volume_play_feedback (volume);
+}
+
+
+
+gdouble
+pulseaudio_volume_get_balance (PulseaudioVolume *volume)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), 0.0);
+
+  return volume->balance;
+}
+
+
+
+/* balance setting callbacks */
+/* pa_sink_info_cb_t */
+static void
+pulseaudio_volume_set_balance_cb2 (pa_context         *context,
+                                   const pa_sink_info *i,
+                                   int                 eol,
+                                   void               *userdata)
+{
+  pa_cvolume cv;
+
+  PulseaudioVolume *volume = PULSEAUDIO_VOLUME (userdata);
+  if (i == NULL) return;
+
+  if (!pa_channel_map_can_balance (&i->channel_map))
+    return;
+
+  cv = i->volume;
+  pa_cvolume_set_balance (&cv, &i->channel_map, volume->balance);
+  pa_context_set_sink_volume_by_index (context, i->index, &cv, pulseaudio_volume_sink_volume_changed, volume);
+}
+
+
+
+/* pa_server_info_cb_t */
+static void
+pulseaudio_volume_set_balance_cb1 (pa_context           *context,
+                                   const pa_server_info *i,
+                                   void                 *userdata)
+{
+  PulseaudioVolume *volume = PULSEAUDIO_VOLUME (userdata);
+  if (i == NULL) return;
+
+  pa_context_get_sink_info_by_name (context, i->default_sink_name, pulseaudio_volume_set_balance_cb2, volume);
+}
+
+
+void
+pulseaudio_volume_set_balance (PulseaudioVolume *volume,
+                               gdouble           balance)
+{
+  gdouble balance_trim;
+
+  g_return_if_fail (IS_PULSEAUDIO_VOLUME (volume));
+  g_return_if_fail (pa_context_get_state (volume->pa_context) == PA_CONTEXT_READY);
+
+  balance_trim = MIN (MAX (balance, -1.0), 1.0);
+
+  if (volume->balance != balance_trim)
+    {
+      volume->balance = balance_trim;
+      pa_context_get_server_info (volume->pa_context, pulseaudio_volume_set_balance_cb1, volume);
+    }
+}
+
+
+
+GListModel *
+pulseaudio_volume_get_sinks (PulseaudioVolume *volume)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), NULL);
+
+  return G_LIST_MODEL (volume->sinks);
+}
+
+
+
+void
+pulseaudio_volume_set_default_sink (PulseaudioVolume *volume,
+                                    PulseaudioSink   *sink)
+{
+  pa_operation *op;
+
+  g_return_if_fail (IS_PULSEAUDIO_VOLUME (volume));
+  g_return_if_fail (IS_PULSEAUDIO_SINK (sink));
+  g_return_if_fail (pa_context_get_state (volume->pa_context) == PA_CONTEXT_READY);
+
+  if (pulseaudio_sink_get_default (sink))
+    return;
+
+  /* the server event that follows updates the registry */
+  op = pa_context_set_default_sink (volume->pa_context, pulseaudio_sink_get_name (sink), NULL, NULL);
+  if (op != NULL)
+    pa_operation_unref (op);
+}
+
+
+
+GListModel *
+pulseaudio_volume_get_sink_inputs (PulseaudioVolume *volume)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), NULL);
+
+  return G_LIST_MODEL (volume->sink_inputs);
+}
+
+
+
+static void pulseaudio_volume_write_stream_volume (PulseaudioVolume *volume,
+                                                   PulseaudioStream *stream);
+
+/* context of a stream volume write */
+typedef struct
+{
+  PulseaudioVolume *volume;
+  PulseaudioStream *stream;
+} PulseaudioStreamWrite;
+
+/* pa_context_success_cb_t */
+static void
+pulseaudio_volume_set_stream_volume_done (pa_context *context,
+                                          int         success,
+                                          void       *userdata)
+{
+  PulseaudioStreamWrite *write = userdata;
+
+  /* send the latest target, intermediate values are skipped */
+  if (pulseaudio_stream_end_write (write->stream))
+    pulseaudio_volume_write_stream_volume (write->volume, write->stream);
+
+  g_object_unref (G_OBJECT (write->stream));
+  g_slice_free (PulseaudioStreamWrite, write);
+}
+
+
+
+static void
+pulseaudio_volume_write_stream_volume (PulseaudioVolume *volume,
+                                       PulseaudioStream *stream)
+{
+  PulseaudioStreamWrite *write;
+  pa_cvolume             cv;
+  pa_operation          *op;
+
+  /* the last reported channel volumes keep the balance intact */
+  cv = *pulseaudio_stream_get_cvolume (stream);
+  if (!pa_cvolume_valid (&cv))
+    pa_cvolume_set (&cv, 1, PA_VOLUME_NORM);
+  pa_cvolume_scale (&cv, pulseaudio_volume_d2v (volume, pulseaudio_stream_get_target_volume (stream)));
+
+  write = g_slice_new (PulseaudioStreamWrite);
+  write->volume = volume;
+  write->stream = g_object_ref (stream);
+
+  op = pa_context_set_sink_input_volume (volume->pa_context, pulseaudio_stream_get_index (stream), &cv,
+                                         pulseaudio_volume_set_stream_volume_done, write);
+  if (op != NULL)
+    {
+      pa_operation_unref (op);
+    }
+  else
+    {
+      pulseaudio_stream_end_write (stream);
+      g_object_unref (G_OBJECT (stream));
+      g_slice_free (PulseaudioStreamWrite, write);
+    }
+}
+
+
+
+void
+pulseaudio_volume_set_stream_volume (PulseaudioVolume *volume,
+                                     PulseaudioStream *stream,
+                                     gdouble           vol)
+{
   gdouble vol_trim;
 
   g_return_if_fail (IS_PULSEAUDIO_VOLUME (volume));
+  g_return_if_fail (IS_PULSEAUDIO_STREAM (stream));
   g_return_if_fail (pa_context_get_state (volume->pa_context) == PA_CONTEXT_READY);
 
-  vol_max = pulseaudio_config_get_volume_max (volume->config) / 100.0;
-  vol_trim = MIN (MAX (vol, 0.0), vol_max);
+  vol_trim = MIN (MAX (vol, 0.0), volume->vol_max);
 
-  if (volume->volume != vol_trim)
+  /* keep at most one write in flight per stream */
+  if (pulseaudio_stream_get_target_volume (stream) != vol_trim
+      && pulseaudio_stream_begin_write (stream, vol_trim))
+    pulseaudio_volume_write_stream_volume (volume, stream);
+}
+
+
+
+void
+pulseaudio_volume_step_stream_volume (PulseaudioVolume *volume,
+                                      PulseaudioStream *stream,
+                                      gint              steps)
+{
+  gdouble vol;
+  gdouble vol_step;
+
+  g_return_if_fail (IS_PULSEAUDIO_VOLUME (volume));
+  g_return_if_fail (IS_PULSEAUDIO_STREAM (stream));
+
+  if (steps == 0)
+    return;
+
+  vol = pulseaudio_stream_get_target_volume (stream);
+  vol_step = pulseaudio_config_get_volume_step (volume->config) / 100.0;
+
+  if (steps > 0)
+    pulseaudio_volume_set_stream_volume (volume, stream, MIN (vol + steps * vol_step, MAX (vol, 1.0)));
+  else
+    pulseaudio_volume_set_stream_volume (volume, stream, vol + steps * vol_step);
+}
+
+
+
+void
+pulseaudio_volume_set_stream_muted (PulseaudioVolume *volume,
+                                    PulseaudioStream *stream,
+                                    gboolean          muted)
+{
+  pa_operation *op;
+
+  g_return_if_fail (IS_PULSEAUDIO_VOLUME (volume));
+  g_return_if_fail (IS_PULSEAUDIO_STREAM (stream));
+  g_return_if_fail (pa_context_get_state (volume->pa_context) == PA_CONTEXT_READY);
+
+  /* the sink input event that follows updates the registry */
+  op = pa_context_set_sink_input_mute (volume->pa_context, pulseaudio_stream_get_index (stream),
+                                       muted, NULL, NULL);
+  if (op != NULL)
+    pa_operation_unref (op);
+}
+
+
+
+/* pa_context_success_cb_t */
+static void
+pulseaudio_volume_batch_done (pa_context *context,
+                              int         success,
+                              void       *userdata)
+{
+  PulseaudioVolume *volume = PULSEAUDIO_VOLUME (userdata);
+
+  g_return_if_fail (volume->batch_pending > 0);
+
+  if (!success)
+    pulseaudio_debug ("Batched operation failed: %s", pa_strerror (pa_context_errno (context)));
+
+  if (--volume->batch_pending > 0)
+    return;
+
+  /* a single refresh replaces the events held back during the batch */
+  pulseaudio_debug ("Batch complete");
+  pulseaudio_volume_sink_input_sync (volume);
+  pulseaudio_volume_sink_check (volume, context);
+}
+
+
+
+static void
+pulseaudio_volume_batch_add (PulseaudioVolume *volume,
+                             pa_operation     *op)
+{
+  if (op == NULL)
+    return;
+
+  volume->batch_pending++;
+  pa_operation_unref (op);
+}
+
+
+
+static void
+pulseaudio_volume_move_sink_input (PulseaudioVolume *volume,
+                                   PulseaudioStream *stream,
+                                   PulseaudioSink   *sink)
+{
+  if (pulseaudio_stream_get_device (stream) == pulseaudio_sink_get_index (sink))
+    return;
+
+  pulseaudio_debug ("Moving sink input %u to sink %u",
+                    pulseaudio_stream_get_index (stream), pulseaudio_sink_get_index (sink));
+  pulseaudio_volume_batch_add (volume,
+                               pa_context_move_sink_input_by_index (volume->pa_context,
+                                                                    pulseaudio_stream_get_index (stream),
+                                                                    pulseaudio_sink_get_index (sink),
+                                                                    pulseaudio_volume_batch_done,
+                                                                    volume));
+}
+
+
+
+void
+pulseaudio_volume_move_stream (PulseaudioVolume *volume,
+                               PulseaudioStream *stream,
+                               PulseaudioSink   *sink)
+{
+  g_return_if_fail (IS_PULSEAUDIO_VOLUME (volume));
+  g_return_if_fail (IS_PULSEAUDIO_STREAM (stream));
+  g_return_if_fail (IS_PULSEAUDIO_SINK (sink));
+  g_return_if_fail (pa_context_get_state (volume->pa_context) == PA_CONTEXT_READY);
+
+  pulseaudio_volume_move_sink_input (volume, stream, sink);
+}
+
+
+
+/* All moves are issued back-to-back and complete as one batch. */
+void
+pulseaudio_volume_move_all_streams (PulseaudioVolume *volume,
+                                    PulseaudioSink   *sink,
+                                    gboolean          set_default)
+{
+  GListModel       *model;
+  PulseaudioStream *stream;
+  guint             n_items;
+  guint             i;
+
+  g_return_if_fail (IS_PULSEAUDIO_VOLUME (volume));
+  g_return_if_fail (IS_PULSEAUDIO_SINK (sink));
+  g_return_if_fail (pa_context_get_state (volume->pa_context) == PA_CONTEXT_READY);
+
+  model = G_LIST_MODEL (volume->sink_inputs);
+  n_items = g_list_model_get_n_items (model);
+  for (i = 0; i < n_items; i++)
     {
-      volume->volume = vol_trim;
-      pa_context_get_server_info (volume->pa_context, pulseaudio_volume_set_volume_cb1, volume);
+      stream = g_list_model_get_item (model, i);
+      pulseaudio_volume_move_sink_input (volume, stream, sink);
+      g_object_unref (G_OBJECT (stream));
     }
+
+  if (set_default && !pulseaudio_sink_get_default (sink))
+    pulseaudio_volume_batch_add (volume,
+                                 pa_context_set_default_sink (volume->pa_context,
+                                                              pulseaudio_sink_get_name (sink),
+                                                              pulseaudio_volume_batch_done,
+                                                              volume));
+}
+
+
+
+/* Recording streams of other clients, except peak meters */
+GListModel *
+pulseaudio_volume_get_source_outputs (PulseaudioVolume *volume)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), NULL);
+
+  return G_LIST_MODEL (volume->source_outputs);
+}
+
+
+
+GListModel *
+pulseaudio_volume_get_cards (PulseaudioVolume *volume)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), NULL);
+
+  return G_LIST_MODEL (volume->cards);
+}
+
+
+
+/* pa_context_success_cb_t */
+static void
+pulseaudio_volume_switch_done (pa_context *context,
+                               int         success,
+                               void       *userdata)
+{
+  if (!success)
+    g_warning ("Switching the %s failed: %s", (const gchar *) userdata,
+               pa_strerror (pa_context_errno (context)));
+}
+
+
+
+void
+pulseaudio_volume_set_card_profile (PulseaudioVolume *volume,
+                                    PulseaudioCard   *card,
+                                    const gchar      *profile)
+{
+  pa_operation *op;
+
+  g_return_if_fail (IS_PULSEAUDIO_VOLUME (volume));
+  g_return_if_fail (IS_PULSEAUDIO_CARD (card));
+  g_return_if_fail (profile != NULL);
+  g_return_if_fail (pa_context_get_state (volume->pa_context) == PA_CONTEXT_READY);
+
+  if (g_strcmp0 (pulseaudio_card_get_active_profile (card), profile) == 0)
+    return;
+
+  /* the card and sink events that follow update the registries */
+  pulseaudio_debug ("Switching card %u to profile %s", pulseaudio_card_get_index (card), profile);
+  op = pa_context_set_card_profile_by_index (volume->pa_context, pulseaudio_card_get_index (card),
+                                             profile, pulseaudio_volume_switch_done, (gpointer) "card profile");
+  if (op != NULL)
+    pa_operation_unref (op);
+  else
+    g_warning ("Switching the card profile failed: %s", pa_strerror (pa_context_errno (volume->pa_context)));
+}
+
+
+
+/* The port must be one of the sink's own, see pulseaudio_sink_get_port_name() */
+void
+pulseaudio_volume_set_sink_port (PulseaudioVolume *volume,
+                                 PulseaudioSink   *sink,
+                                 const gchar      *port)
+{
+  pa_operation *op;
+
+  g_return_if_fail (IS_PULSEAUDIO_VOLUME (volume));
+  g_return_if_fail (IS_PULSEAUDIO_SINK (sink));
+  g_return_if_fail (port != NULL);
+  g_return_if_fail (pa_context_get_state (volume->pa_context) == PA_CONTEXT_READY);
+
+  if (g_strcmp0 (pulseaudio_sink_get_active_port (sink), port) == 0)
+    return;
+
+  pulseaudio_debug ("Switching sink %u to port %s", pulseaudio_sink_get_index (sink), port);
+  op = pa_context_set_sink_port_by_index (volume->pa_context, pulseaudio_sink_get_index (sink),
+                                          port, pulseaudio_volume_switch_done, (gpointer) "sink port");
+  if (op != NULL)
+    pa_operation_unref (op);
+  else
+    g_warning ("Switching the sink port failed: %s", pa_strerror (pa_context_errno (volume->pa_context)));
+}
+
+
+
+/* Returns a new peak meter on the monitor of the default sink, or NULL
+ * if that is not known yet. The stream is closed when the meter is
+ * released. */
+PulseaudioMeter *
+pulseaudio_volume_new_meter (PulseaudioVolume *volume,
+                             guint             rate)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), NULL);
+
+  if (!volume->connected || volume->monitor_source_name == NULL)
+    return NULL;
+
+  return pulseaudio_meter_new (volume->pa_context, volume->monitor_source_name, rate, FALSE);
+}
+
+
+
+/* A peak meter on a single playback stream, wherever it plays. */
+PulseaudioMeter *
+pulseaudio_volume_new_stream_meter (PulseaudioVolume *volume,
+                                    PulseaudioStream *stream,
+                                    guint             rate)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), NULL);
+  g_return_val_if_fail (IS_PULSEAUDIO_STREAM (stream), NULL);
+
+  if (!volume->connected)
+    return NULL;
+
+  return pulseaudio_meter_new_for_sink_input (volume->pa_context, pulseaudio_stream_get_index (stream), rate);
+}
+
+
+
+/* Same as pulseaudio_volume_new_meter() but the meter captures the
+ * signal for analysis, see pulseaudio_meter_get_samples(). */
+PulseaudioMeter *
+pulseaudio_volume_new_capture (PulseaudioVolume *volume,
+                               guint             rate)
+{
+  g_return_val_if_fail (IS_PULSEAUDIO_VOLUME (volume), NULL);
+
+  if (!volume->connected || volume->monitor_source_name == NULL)
+    return NULL;
+
+  return pulseaudio_meter_new (volume->pa_context, volume->monitor_source_name, rate, TRUE);
 }
 
 
@@ -479,6 +2083,18 @@ pulseaudio_volume_new (PulseaudioConfig *config)
 
   volume = g_object_new (TYPE_PULSEAUDIO_VOLUME, NULL);
   volume->config = config;
+  pulseaudio_volume_build_curve (volume);
+
+  g_signal_connect_swapped (G_OBJECT (config), "notify::volume-max",
+                            G_CALLBACK (pulseaudio_volume_curve_changed), volume);
+  g_signal_connect_swapped (G_OBJECT (config), "notify::volume-curve",
+                            G_CALLBACK (pulseaudio_volume_curve_changed), volume);
+  g_signal_connect_swapped (G_OBJECT (config), "notify::volume-db-range",
+                            G_CALLBACK (pulseaudio_volume_curve_changed), volume);
+
+  /* the sample is only uploaded once feedback is enabled */
+  g_signal_connect_swapped (G_OBJECT (config), "notify::play-feedback",
+                            G_CALLBACK (pulseaudio_volume_feedback_upload), volume);
 
   return volume;
 }
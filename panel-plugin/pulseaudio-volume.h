@@ -19,7 +19,12 @@
 #define __PULSEAUDIO_VOLUME_H__
 
 #include <glib-object.h>
+#include <gio/gio.h>
+#include "pulseaudio-card.h"
 #include "pulseaudio-config.h"
+#include "pulseaudio-meter.h"
+#include "pulseaudio-sink.h"
+#include "pulseaudio-stream.h"
 
 G_BEGIN_DECLS
 
@@ -38,14 +43,71 @@ GType                   pulseaudio_volume_get_type        (void) G_GNUC_CONST;
 PulseaudioVolume       *pulseaudio_volume_new             (PulseaudioConfig *config);
 
 gdouble                 pulseaudio_volume_get_volume      (PulseaudioVolume *volume);
+gdouble                 pulseaudio_volume_get_target_volume (PulseaudioVolume *volume);
 void                    pulseaudio_volume_set_volume      (PulseaudioVolume *volume,
                                                            gdouble           vol);
+void                    pulseaudio_volume_step_volume     (PulseaudioVolume *volume,
+                                                           gint              steps,
+                                                           gboolean          boost);
 
 gboolean                pulseaudio_volume_get_muted       (PulseaudioVolume *volume);
 void                    pulseaudio_volume_set_muted       (PulseaudioVolume *volume,
                                                            gboolean          muted);
 void                    pulseaudio_volume_toggle_muted    (PulseaudioVolume *volume);
 
+gdouble                 pulseaudio_volume_get_balance     (PulseaudioVolume *volume);
+void                    pulseaudio_volume_set_balance     (PulseaudioVolume *volume,
+                                                           gdouble           balance);
+
+GListModel             *pulseaudio_volume_get_sinks       (PulseaudioVolume *volume);
+void                    pulseaudio_volume_set_default_sink (PulseaudioVolume *volume,
+                                                           PulseaudioSink   *sink);
+
+GListModel             *pulseaudio_volume_get_sink_inputs (PulseaudioVolume *volume);
+void                    pulseaudio_volume_set_stream_volume (PulseaudioVolume *volume,
+                                                           PulseaudioStream *stream,
+                                                           gdouble           vol);
+void                    pulseaudio_volume_step_stream_volume (PulseaudioVolume *volume,
+                                                           PulseaudioStream *stream,
+                                                           gint              steps);
+void                    pulseaudio_volume_set_stream_muted (PulseaudioVolume *volume,
+                                                           PulseaudioStream *stream,
+                                                           gboolean          muted);
+void                    pulseaudio_volume_move_stream     (PulseaudioVolume *volume,
+                                                           PulseaudioStream *stream,
+                                                           PulseaudioSink   *sink);
+void                    pulseaudio_volume_move_all_streams (PulseaudioVolume *volume,
+                                                           PulseaudioSink   *sink,
+                                                           gboolean          set_default);
+
+GListModel             *pulseaudio_volume_get_source_outputs (PulseaudioVolume *volume);
+
+GListModel             *pulseaudio_volume_get_cards       (PulseaudioVolume *volume);
+void                    pulseaudio_volume_set_card_profile (PulseaudioVolume *volume,
+                                                           PulseaudioCard   *card,
+                                                           const gchar      *profile);
+void                    pulseaudio_volume_set_sink_port   (PulseaudioVolume *volume,
+                                                           PulseaudioSink   *sink,
+                                                           const gchar      *port);
+
+PulseaudioMeter        *pulseaudio_volume_new_meter       (PulseaudioVolume *volume,
+                                                           guint             rate);
+PulseaudioMeter        *pulseaudio_volume_new_stream_meter (PulseaudioVolume *volume,
+                                                           PulseaudioStream *stream,
+                                                           guint             rate);
+PulseaudioMeter        *pulseaudio_volume_new_capture     (PulseaudioVolume *volume,
+                                                           guint             rate);
+
+void                    pulseaudio_volume_set_ui_visible  (PulseaudioVolume *volume,
+                                                           gboolean          visible);
+gboolean                pulseaudio_volume_get_ui_visible  (PulseaudioVolume *volume);
+
+gboolean                pulseaudio_volume_get_sink_running (PulseaudioVolume *volume);
+
+void                    pulseaudio_volume_sample_latency  (PulseaudioVolume *volume);
+guint64                 pulseaudio_volume_get_sink_latency (PulseaudioVolume *volume);
+guint64                 pulseaudio_volume_get_sink_configured_latency (PulseaudioVolume *volume);
+
 G_END_DECLS
 
 #endif /* !__PULSEAUDIO_VOLUME_H__ */
@@ -47,6 +47,7 @@ static gboolean scale_menu_item_motion_notify_event     (GtkWidget          *men
 static void     scale_menu_item_parent_set              (GtkWidget          *item,
                                                          GtkWidget          *previous_parent);
 static void     update_packing                          (ScaleMenuItem  *    self);
+static void     scale_menu_item_finalize                (GObject            *object);
 
 
 
@@ -55,6 +56,7 @@ struct _ScaleMenuItemPrivate {
   GtkWidget            *scale;
   GtkWidget            *description_label;
   GtkWidget            *percentage_label;
+  GtkWidget            *meter;
   GtkWidget            *vbox;
   GtkWidget            *hbox;
   gboolean              grabbed;
@@ -106,6 +108,7 @@ scale_menu_item_class_init (ScaleMenuItemClass *item_class)
   widget_class->motion_notify_event  = scale_menu_item_motion_notify_event;
   widget_class->parent_set           = scale_menu_item_parent_set;
 
+  gobject_class->finalize            = scale_menu_item_finalize;
 
   /**
    * ScaleMenuItem::slider-grabbed:
@@ -232,6 +235,10 @@ update_packing (ScaleMenuItem *self)
   }
 
 
+  /* the meter goes under the slider, its visibility is left to the owner */
+  if (priv->meter)
+    gtk_box_pack_start (vbox, priv->meter, FALSE, FALSE, 0);
+
   gtk_widget_show_all (priv->vbox);
   gtk_widget_show_all (priv->hbox);
 
@@ -243,6 +250,23 @@ scale_menu_item_init (ScaleMenuItem *self)
 {
 }
 
+static void
+scale_menu_item_finalize (GObject *object)
+{
+  ScaleMenuItemPrivate *priv = GET_PRIVATE (object);
+
+  if (priv->meter)
+    g_object_unref (priv->meter);
+
+  if (priv->description_label)
+    g_object_unref (priv->description_label);
+
+  if (priv->percentage_label)
+    g_object_unref (priv->percentage_label);
+
+  G_OBJECT_CLASS (scale_menu_item_parent_class)->finalize (object);
+}
+
 static gboolean
 scale_menu_item_button_press_event (GtkWidget      *menuitem,
                                     GdkEventButton *event)
@@ -490,29 +514,33 @@ scale_menu_item_set_description_label (ScaleMenuItem *menuitem,
 
   priv = GET_PRIVATE (menuitem);
 
-  if (label == NULL && priv->description_label)
+  if (label == NULL)
     {
-      /* remove label */
-      g_object_unref (priv->description_label);
-      priv->description_label = NULL;
+      if (priv->description_label)
+        {
+          /* remove label */
+          g_object_unref (priv->description_label);
+          priv->description_label = NULL;
+          update_packing (menuitem);
+        }
       return;
     }
 
-  if (priv->description_label && label)
+  if (priv->description_label)
     {
+      /* only the text changes, the layout stays */
       gtk_label_set_markup (GTK_LABEL (priv->description_label), label);
+      return;
     }
-  else if(label)
-    {
-      /* create label */
-      priv->description_label = gtk_label_new (NULL);
-      gtk_label_set_markup (GTK_LABEL (priv->description_label), label);
 
-      /* align left */
-      gtk_misc_set_alignment (GTK_MISC(priv->description_label), 0, 0);
-    }
+  /* create label, referenced since repacking takes it out of its box */
+  priv->description_label = g_object_ref_sink (gtk_label_new (NULL));
+  gtk_label_set_markup (GTK_LABEL (priv->description_label), label);
+
+  /* align left */
+  gtk_misc_set_alignment (GTK_MISC(priv->description_label), 0, 0);
 
-    update_packing (menuitem);
+  update_packing (menuitem);
 }
 
 
@@ -534,27 +562,63 @@ scale_menu_item_set_percentage_label (ScaleMenuItem *menuitem,
 
   priv = GET_PRIVATE (menuitem);
 
-  if (label == NULL && priv->percentage_label)
+  if (label == NULL)
     {
-      /* remove label */
-      g_object_unref (priv->percentage_label);
-      priv->percentage_label = NULL;
+      if (priv->percentage_label)
+        {
+          /* remove label */
+          g_object_unref (priv->percentage_label);
+          priv->percentage_label = NULL;
+          update_packing (menuitem);
+        }
       return;
     }
 
-  if (priv->percentage_label && label)
+  if (priv->percentage_label)
     {
+      /* only the text changes, the layout stays */
       gtk_label_set_text (GTK_LABEL (priv->percentage_label), label);
+      return;
     }
-  else if(label)
-    {
-      /* create label */
-      priv->percentage_label = gtk_label_new (label);
-      /* align left */
-      gtk_misc_set_alignment (GTK_MISC(priv->percentage_label), 0, 0);
-    }
 
-    update_packing (menuitem);
+  /* create label, referenced since repacking takes it out of its box */
+  priv->percentage_label = g_object_ref_sink (gtk_label_new (label));
+
+  /* align left */
+  gtk_misc_set_alignment (GTK_MISC(priv->percentage_label), 0, 0);
+
+  update_packing (menuitem);
+}
+
+
+/**
+ * scale_menu_item_set_meter:
+ * @menuitem: The #ScaleMenuItem
+ * @meter: (allow-none): The meter widget
+ *
+ * Sets a widget, typically a #GtkLevelBar, shown under the slider. If
+ * meter is NULL then the current one is removed from the #ScaleMenuItem.
+ **/
+void
+scale_menu_item_set_meter (ScaleMenuItem *menuitem,
+                           GtkWidget     *meter)
+{
+  ScaleMenuItemPrivate *priv;
+
+  g_return_if_fail (IS_SCALE_MENU_ITEM (menuitem));
+  g_return_if_fail (meter == NULL || GTK_IS_WIDGET (meter));
+
+  priv = GET_PRIVATE (menuitem);
+
+  if (priv->meter)
+    g_object_unref (priv->meter);
+
+  /* keep a reference, the widget is repacked on every layout change */
+  priv->meter = meter ? g_object_ref_sink (meter) : NULL;
+  if (priv->meter)
+    gtk_widget_set_no_show_all (priv->meter, TRUE);
+
+  update_packing (menuitem);
 }
 
 
@@ -73,6 +73,9 @@ void         scale_menu_item_set_description_label (ScaleMenuItem *menuitem,
 void         scale_menu_item_set_percentage_label  (ScaleMenuItem *menuitem,
                                                     const gchar      *label);
 
+void         scale_menu_item_set_meter             (ScaleMenuItem *menuitem,
+                                                    GtkWidget     *meter);
+
 void        scale_menu_item_set_value (ScaleMenuItem *item,
                                        gdouble        value);
 
@@ -0,0 +1,109 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+
+/*
+ *  Times every sample kernel the CPU supports on the buffer shapes the
+ *  meters use. Not run by "make check", start it by hand.
+ *
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib.h>
+
+#include "panel-plugin/pulseaudio-kernels.h"
+
+
+/* how long each case runs */
+#define BENCH_TIME (G_USEC_PER_SEC / 4)
+
+typedef struct
+{
+  const gchar *label;
+  gsize        n_frames;
+  guint        channels;
+} BenchCase;
+
+static const BenchCase cases[] =
+{
+  { "peak period",      1,    1 },
+  { "capture fragment", 640,  1 },
+  { "stereo 1024",      1024, 2 },
+  { "stereo 4096",      4096, 2 },
+};
+
+
+
+int
+main (int    argc,
+      char **argv)
+{
+  PulseaudioKernelFunc func;
+  gfloat              *samples;
+  gfloat               peak[2], sumsq[2];
+  volatile gfloat      sink = 0.0f;
+  gint64               start, elapsed;
+  guint64              calls;
+  guint                width;
+  guint                n, c;
+  gsize                i;
+
+  samples = g_new (gfloat, 4096 * 2);
+  for (i = 0; i < 4096 * 2; i++)
+    samples[i] = (gfloat) g_random_double_range (-1.0, 1.0);
+
+  g_print ("%-8s %-18s %12s %12s\n", "kernel", "buffer", "ns/call", "ns/sample");
+
+  for (n = 0; n < pulseaudio_kernels_get_n_variants (); n++)
+    {
+      pulseaudio_kernels_get_variant (n, &func, &width);
+
+      for (c = 0; c < G_N_ELEMENTS (cases); c++)
+        {
+          /* the scalar loop takes any channel count */
+          if (n > 0 && width % cases[c].channels != 0)
+            continue;
+
+          calls = 0;
+          start = g_get_monotonic_time ();
+          do
+            {
+              for (i = 0; i < 1000; i++)
+                func (samples, cases[c].n_frames, cases[c].channels, peak, sumsq);
+              sink += peak[0];
+              calls += 1000;
+              elapsed = g_get_monotonic_time () - start;
+            }
+          while (elapsed < BENCH_TIME);
+
+          g_print ("%-8s %-18s %12.2f %12.3f\n",
+                   pulseaudio_kernels_get_variant (n, NULL, NULL), cases[c].label,
+                   1e3 * elapsed / calls,
+                   1e3 * elapsed / calls / (cases[c].n_frames * cases[c].channels));
+        }
+    }
+
+  g_free (samples);
+
+  return 0;
+}
@@ -0,0 +1,96 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+
+/*
+ *  Times one spectrum frame: window, FFT and folding into bands, on
+ *  noise and on a sine. Not run by "make check", start it by hand.
+ *
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <math.h>
+#include <string.h>
+#include <glib.h>
+
+#include "panel-plugin/pulseaudio-analyzer.h"
+
+
+/* how long each case runs */
+#define BENCH_TIME (G_USEC_PER_SEC / 2)
+
+/* the rate the spectrum view redraws at on a typical display */
+#define BENCH_FRAME_RATE 60
+
+
+
+int
+main (int    argc,
+      char **argv)
+{
+  static const gchar  *labels[] = { "noise", "sine 1 kHz" };
+  PulseaudioAnalyzer  *analyzer;
+  gfloat              *input;
+  gfloat               blocks[2][PULSEAUDIO_ANALYZER_SIZE];
+  gfloat               levels[PULSEAUDIO_ANALYZER_N_BANDS];
+  volatile gfloat      sink = 0.0f;
+  gint64               start, elapsed;
+  guint64              frames;
+  guint                c, i;
+
+  analyzer = pulseaudio_analyzer_new ();
+  input = pulseaudio_analyzer_get_input (analyzer);
+
+  for (i = 0; i < PULSEAUDIO_ANALYZER_SIZE; i++)
+    {
+      blocks[0][i] = (gfloat) g_random_double_range (-1.0, 1.0);
+      blocks[1][i] = (gfloat) sin (2.0 * G_PI * 1000.0 * i / PULSEAUDIO_ANALYZER_RATE);
+    }
+
+  g_print ("%-12s %12s %16s\n", "input", "us/frame", "core at 60 Hz");
+
+  for (c = 0; c < G_N_ELEMENTS (labels); c++)
+    {
+      frames = 0;
+      start = g_get_monotonic_time ();
+      do
+        {
+          /* the view copies a new block in every frame too */
+          memcpy (input, blocks[c], sizeof (blocks[c]));
+
+          pulseaudio_analyzer_run (analyzer, levels);
+          sink += levels[0];
+          frames++;
+          elapsed = g_get_monotonic_time () - start;
+        }
+      while (elapsed < BENCH_TIME);
+
+      g_print ("%-12s %12.2f %15.4f%%\n", labels[c],
+               (gdouble) elapsed / frames,
+               100.0 * BENCH_FRAME_RATE * elapsed / frames / G_USEC_PER_SEC);
+    }
+
+  pulseaudio_analyzer_free (analyzer);
+
+  return 0;
+}
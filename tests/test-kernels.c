@@ -0,0 +1,171 @@
+/*  Copyright (c) 2015 Andrzej <ndrwrdck@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+
+/*
+ *  Checks every sample kernel the CPU supports against the scalar
+ *  reference. Peaks must match exactly, sums of squares within a
+ *  relative tolerance, since the vector versions add in another order.
+ *
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <math.h>
+#include <string.h>
+#include <glib.h>
+
+#include "panel-plugin/pulseaudio-kernels.h"
+
+
+#define MAX_CHANNELS 8
+#define MAX_FRAMES   4099
+
+/* relative error allowed for the float sums */
+#define SUM_TOLERANCE 1e-4
+
+
+
+static gfloat *
+make_samples (gsize n)
+{
+  gfloat *samples;
+  gsize   i;
+
+  samples = g_new (gfloat, n);
+  for (i = 0; i < n; i++)
+    samples[i] = (gfloat) g_random_double_range (-1.0, 1.0);
+
+  return samples;
+}
+
+
+
+static void
+check_variant (guint                n,
+               PulseaudioKernelFunc func,
+               guint                width,
+               const gfloat        *samples,
+               gsize                n_frames,
+               guint                channels)
+{
+  PulseaudioKernelFunc scalar;
+  gfloat               peak[MAX_CHANNELS], sumsq[MAX_CHANNELS];
+  gfloat               ref_peak[MAX_CHANNELS], ref_sumsq[MAX_CHANNELS];
+  guint                ch;
+
+  pulseaudio_kernels_get_variant (0, &scalar, NULL);
+  scalar (samples, n_frames, channels, ref_peak, ref_sumsq);
+
+  /* channel counts a variant cannot handle go through the dispatcher,
+   * which must fall back to the scalar loop */
+  if (width % channels == 0)
+    func (samples, n_frames, channels, peak, sumsq);
+  else
+    pulseaudio_kernels_reduce (samples, n_frames, channels, peak, sumsq);
+
+  for (ch = 0; ch < channels; ch++)
+    {
+      if (peak[ch] != ref_peak[ch])
+        g_error ("%s: peak of channel %u/%u over %" G_GSIZE_FORMAT " frames is %.9g, expected %.9g",
+                 pulseaudio_kernels_get_variant (n, NULL, NULL), ch, channels, n_frames,
+                 peak[ch], ref_peak[ch]);
+
+      if (fabs (sumsq[ch] - ref_sumsq[ch]) > SUM_TOLERANCE * MAX (ref_sumsq[ch], 1.0f))
+        g_error ("%s: sum of channel %u/%u over %" G_GSIZE_FORMAT " frames is %.9g, expected %.9g",
+                 pulseaudio_kernels_get_variant (n, NULL, NULL), ch, channels, n_frames,
+                 sumsq[ch], ref_sumsq[ch]);
+    }
+}
+
+
+
+static void
+test_kernels_exact (void)
+{
+  static const guint channel_counts[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  PulseaudioKernelFunc func;
+  gfloat              *samples;
+  gsize                n_frames;
+  guint                width;
+  guint                n, c;
+
+  samples = make_samples (MAX_FRAMES * MAX_CHANNELS);
+
+  for (n = 1; n < pulseaudio_kernels_get_n_variants (); n++)
+    {
+      pulseaudio_kernels_get_variant (n, &func, &width);
+      g_test_message ("checking %s, width %u", pulseaudio_kernels_get_variant (n, NULL, NULL), width);
+
+      for (c = 0; c < G_N_ELEMENTS (channel_counts); c++)
+        {
+          /* every tail length around the vector width */
+          for (n_frames = 0; n_frames <= 4 * width + 3; n_frames++)
+            check_variant (n, func, width, samples, n_frames, channel_counts[c]);
+
+          /* the buffer sizes the meters actually see */
+          check_variant (n, func, width, samples, 640, channel_counts[c]);
+          check_variant (n, func, width, samples, MAX_FRAMES, channel_counts[c]);
+        }
+    }
+
+  g_free (samples);
+}
+
+
+
+/* silence and a peak in the very last sample, which only the tail sees */
+static void
+test_kernels_edges (void)
+{
+  PulseaudioKernelFunc func;
+  gfloat               samples[67];
+  guint                width;
+  guint                n;
+
+  memset (samples, 0, sizeof (samples));
+
+  for (n = 0; n < pulseaudio_kernels_get_n_variants (); n++)
+    {
+      pulseaudio_kernels_get_variant (n, &func, &width);
+
+      samples[G_N_ELEMENTS (samples) - 1] = 0.0f;
+      check_variant (n, func, width, samples, G_N_ELEMENTS (samples), 1);
+
+      samples[G_N_ELEMENTS (samples) - 1] = -0.75f;
+      check_variant (n, func, width, samples, G_N_ELEMENTS (samples), 1);
+    }
+}
+
+
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/kernels/exact", test_kernels_exact);
+  g_test_add_func ("/kernels/edges", test_kernels_edges);
+
+  return g_test_run ();
+}